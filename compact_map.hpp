@@ -0,0 +1,676 @@
+#ifndef SJTU_COMPACT_MAP_HPP
+#define SJTU_COMPACT_MAP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <new>
+#include <utility>
+#include "utility.hpp"
+#include "exceptions.hpp"
+
+namespace sjtu {
+/**
+ * a sorted map for very many small elements, with the same interface as map for the
+ *   common operations but a fraction of its memory overhead.
+ * it is an AVL tree whose nodes live in a node array and link to each other by 32-bit
+ *   indices; there are no parent pointers, and the balance factor is kept in the top bits
+ *   of the two child indices. a node is the two indices followed by the value_type itself,
+ *   so an element costs 8 bytes plus sizeof(value_type), against about 80 bytes and two
+ *   heap blocks in map. memory_usage() reports the bytes actually held.
+ * the array grows in blocks that are never moved, so references to elements stay valid
+ *   until the element is erased. iterators keep the path from the root to their element
+ *   and are invalidated by every insertion or erasure.
+ * at most 2^31 - 16 elements: indices stop below NIL and the node array grows in whole blocks.
+ */
+template<class Key, class T, class Compare = std::less<Key>>
+class compact_map {
+public:
+    typedef pair<const Key, T> value_type;
+private:
+    static const uint32_t NIL = 0x7fffffffu;
+    static const uint32_t HEAVY = 0x80000000u;
+    //空闲槽位的左儿子标记：左儿子为空却左边更高，正常结点不会这样
+    static const uint32_t FREE = NIL | HEAVY;
+    //第k块有2^(k+FIRST_BITS)个槽位，下标x在第floor(log2(x+FIRST))-FIRST_BITS块
+    static const int FIRST_BITS = 4;
+    static const uint32_t FIRST = 1u << FIRST_BITS;
+    static const int MAX_BLOCKS = 32 - FIRST_BITS;
+    //l、r的最高位分别表示左、右子树更高，两位都为0表示一样高
+    class slot {
+    public:
+        uint32_t l, r;
+        alignas(value_type) unsigned char buf[sizeof(value_type)];
+        value_type *val() {
+            return reinterpret_cast<value_type *>(buf);
+        }
+    };
+    slot *blocks[MAX_BLOCKS];
+    int nblocks;
+    //used为用过的槽位数，空闲的槽位通过r串成链表
+    uint32_t used, free_head, rt;
+    size_t cur_size;
+
+    //前n块的槽位数，按64位算，n=MAX_BLOCKS时也不会溢出
+    static uint64_t capacity_of(int n) {
+        return (uint64_t(FIRST) << n) - FIRST;
+    }
+    slot &at_slot(uint32_t x) const {
+        uint32_t y = x + FIRST;
+        int k = 31 - __builtin_clz(y);
+        return blocks[k - FIRST_BITS][y - (1u << k)];
+    }
+    value_type &val(uint32_t x) const {
+        return *at_slot(x).val();
+    }
+    uint32_t ls(uint32_t x) const {
+        return at_slot(x).l & NIL;
+    }
+    uint32_t rs(uint32_t x) const {
+        return at_slot(x).r & NIL;
+    }
+    void set_ls(uint32_t x, uint32_t c) {
+        slot &s = at_slot(x);
+        s.l = (s.l & HEAVY) | c;
+    }
+    void set_rs(uint32_t x, uint32_t c) {
+        slot &s = at_slot(x);
+        s.r = (s.r & HEAVY) | c;
+    }
+    //右子树高度减左子树高度，只可能是-1、0、1
+    int bal(uint32_t x) const {
+        const slot &s = at_slot(x);
+        return int(s.r >> 31) - int(s.l >> 31);
+    }
+    void set_bal(uint32_t x, int b) {
+        slot &s = at_slot(x);
+        s.l = (s.l & NIL) | (b < 0 ? HEAVY : 0);
+        s.r = (s.r & NIL) | (b > 0 ? HEAVY : 0);
+    }
+    //key与结点x的键比较：小于返回负数，大于返回正数，相等返回0
+    int compare(const Key &key, uint32_t x) const {
+        if (Compare()(key, val(x).first)) return -1;
+        if (Compare()(val(x).first, key)) return 1;
+        return 0;
+    }
+
+    void add_block() {
+        if (nblocks == MAX_BLOCKS || capacity_of(nblocks + 1) > NIL) throw runtime_error();
+        blocks[nblocks] = static_cast<slot *>(::operator new(sizeof(slot) * (size_t(FIRST) << nblocks)));
+        ++nblocks;
+    }
+    //取一个槽位构造新元素，新结点没有孩子，两边一样高
+    template<class... Args>
+    uint32_t alloc(Args&&... args) {
+        uint32_t x = free_head;
+        if (x == NIL) {
+            if (used == capacity_of(nblocks)) add_block();
+            x = used;
+        }
+        slot &s = at_slot(x);
+        new (s.buf) value_type(std::forward<Args>(args)...);
+        if (x == free_head) free_head = s.r;
+        else ++used;
+        s.l = NIL;
+        s.r = NIL;
+        ++cur_size;
+        return x;
+    }
+    void release(uint32_t x) {
+        slot &s = at_slot(x);
+        s.val()->~value_type();
+        s.l = FREE;
+        s.r = free_head;
+        free_head = x;
+        --cur_size;
+    }
+    void destroy() {
+        for (uint32_t x = 0; x < used;++x)
+            if (at_slot(x).l != FREE) at_slot(x).val()->~value_type();
+        for (int i = 0; i < nblocks;++i) ::operator delete(blocks[i]);
+        nblocks = 0;
+        used = 0;
+        free_head = NIL;
+        rt = NIL;
+        cur_size = 0;
+    }
+
+    void rotate_left(uint32_t &t) {
+        uint32_t r = rs(t);
+        set_rs(t, ls(r));
+        set_ls(r, t);
+        t = r;
+    }
+    void rotate_right(uint32_t &t) {
+        uint32_t l = ls(t);
+        set_ls(t, rs(l));
+        set_rs(l, t);
+        t = l;
+    }
+    //t的左子树高了2，ls(t)不是右边更高时单旋，否则双旋；返回t的高度是否比失衡前的最高时降了1
+    bool fix_left(uint32_t &t) {
+        uint32_t l = ls(t);
+        int b = bal(l);
+        if (b <= 0) {
+            rotate_right(t);
+            set_bal(t, b == 0 ? 1 : 0);
+            set_bal(rs(t), b == 0 ? -1 : 0);
+            return b != 0;
+        }
+        int c = bal(rs(l));
+        uint32_t tmp = l;
+        rotate_left(tmp);
+        set_ls(t, tmp);
+        rotate_right(t);
+        set_bal(ls(t), c > 0 ? -1 : 0);
+        set_bal(rs(t), c < 0 ? 1 : 0);
+        set_bal(t, 0);
+        return true;
+    }
+    bool fix_right(uint32_t &t) {
+        uint32_t r = rs(t);
+        int b = bal(r);
+        if (b >= 0) {
+            rotate_left(t);
+            set_bal(t, b == 0 ? -1 : 0);
+            set_bal(ls(t), b == 0 ? 1 : 0);
+            return b != 0;
+        }
+        int c = bal(ls(r));
+        uint32_t tmp = r;
+        rotate_right(tmp);
+        set_rs(t, tmp);
+        rotate_left(t);
+        set_bal(ls(t), c > 0 ? -1 : 0);
+        set_bal(rs(t), c < 0 ? 1 : 0);
+        set_bal(t, 0);
+        return true;
+    }
+    //左（右）子树长高了，返回t是否长高
+    bool grow_left(uint32_t &t) {
+        int b = bal(t);
+        if (b >= 0) {
+            set_bal(t, b - 1);
+            return b == 0;
+        }
+        fix_left(t);
+        return false;
+    }
+    bool grow_right(uint32_t &t) {
+        int b = bal(t);
+        if (b <= 0) {
+            set_bal(t, b + 1);
+            return b == 0;
+        }
+        fix_right(t);
+        return false;
+    }
+    //左（右）子树变矮了，返回t是否变矮
+    bool shrink_left(uint32_t &t) {
+        int b = bal(t);
+        if (b <= 0) {
+            set_bal(t, b + 1);
+            return b < 0;
+        }
+        return fix_right(t);
+    }
+    bool shrink_right(uint32_t &t) {
+        int b = bal(t);
+        if (b >= 0) {
+            set_bal(t, b - 1);
+            return b > 0;
+        }
+        return fix_left(t);
+    }
+    //在子树t中插入键key，不存在时用args构造；res为key所在的结点，返回t是否长高
+    template<class... Args>
+    bool insert(uint32_t &t, const Key &key, uint32_t &res, bool &inserted, Args&&... args) {
+        if (t == NIL) {
+            t = res = alloc(std::forward<Args>(args)...);
+            inserted = true;
+            return true;
+        }
+        int c = compare(key, t);
+        if (c == 0) {
+            res = t;
+            inserted = false;
+            return false;
+        }
+        if (c < 0) {
+            uint32_t l = ls(t);
+            bool g = insert(l, key, res, inserted, std::forward<Args>(args)...);
+            set_ls(t, l);
+            return g && grow_left(t);
+        }
+        uint32_t r = rs(t);
+        bool g = insert(r, key, res, inserted, std::forward<Args>(args)...);
+        set_rs(t, r);
+        return g && grow_right(t);
+    }
+    //从子树t中摘下最小的结点m（不释放），返回t是否变矮
+    bool unlink_min(uint32_t &t, uint32_t &m) {
+        uint32_t l = ls(t);
+        if (l == NIL) {
+            m = t;
+            t = rs(t);
+            return true;
+        }
+        bool s = unlink_min(l, m);
+        set_ls(t, l);
+        return s && shrink_left(t);
+    }
+    //返回t是否变矮；两个孩子都在时用右子树的最小结点顶替，不拷贝元素
+    bool erase(uint32_t &t, const Key &key, bool &found) {
+        if (t == NIL) return false;
+        int c = compare(key, t);
+        if (c < 0) {
+            uint32_t l = ls(t);
+            bool s = erase(l, key, found);
+            set_ls(t, l);
+            return s && shrink_left(t);
+        }
+        if (c > 0) {
+            uint32_t r = rs(t);
+            bool s = erase(r, key, found);
+            set_rs(t, r);
+            return s && shrink_right(t);
+        }
+        found = true;
+        uint32_t x = t;
+        if (ls(x) == NIL || rs(x) == NIL) {
+            t = (ls(x) == NIL ? rs(x) : ls(x));
+            release(x);
+            return true;
+        }
+        uint32_t r = rs(x), m;
+        bool s = unlink_min(r, m);
+        at_slot(m).l = at_slot(x).l;
+        at_slot(m).r = at_slot(x).r;
+        set_rs(m, r);
+        t = m;
+        release(x);
+        return s && shrink_right(t);
+    }
+    int height(uint32_t t) const {
+        int h = 0;
+        //沿着较高的一边走到底
+        while (t != NIL) {
+            ++h;
+            t = (bal(t) < 0 ? ls(t) : rs(t));
+        }
+        return h;
+    }
+
+public:
+    class iterator;
+    /**
+     * an iterator keeps the path from the root to its element, d == 0 is end().
+     */
+    class const_iterator {
+        friend class compact_map;
+    protected:
+        //AVL的高度不超过1.44log(n+2)，2^31个元素也不到48层
+        static const int MAX_DEPTH = 48;
+        const compact_map *m;
+        uint32_t stk[MAX_DEPTH];
+        int d;
+        void push_left(uint32_t x) {
+            for (; x != NIL; x = m->ls(x)) stk[d++] = x;
+        }
+        void push_right(uint32_t x) {
+            for (; x != NIL; x = m->rs(x)) stk[d++] = x;
+        }
+        explicit const_iterator(const compact_map *_m) : m(_m), d(0) {}
+    public:
+        const_iterator() : m(nullptr), d(0) {}
+        const_iterator(const const_iterator &other) : m(other.m), d(other.d) {
+            for (int i = 0; i < d;++i) stk[i] = other.stk[i];
+        }
+        const_iterator &operator=(const const_iterator &other) {
+            m = other.m;
+            d = other.d;
+            for (int i = 0; i < d;++i) stk[i] = other.stk[i];
+            return *this;
+        }
+        /**
+         * throw invalid_iterator when moving past the end or before the beginning.
+         */
+        const_iterator &operator++() {
+            if (d == 0) throw invalid_iterator();
+            uint32_t x = stk[d - 1];
+            if (m->rs(x) != NIL) push_left(m->rs(x));
+            else {
+                //一路弹栈直到从左子树回来
+                uint32_t c;
+                do c = stk[--d]; while (d > 0 && m->rs(stk[d - 1]) == c);
+            }
+            return *this;
+        }
+        const_iterator operator++(int) {
+            const_iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+        const_iterator &operator--() {
+            if (m == nullptr) throw invalid_iterator();
+            if (d == 0) {
+                if (m->rt == NIL) throw invalid_iterator();
+                push_right(m->rt);
+                return *this;
+            }
+            uint32_t x = stk[d - 1];
+            if (m->ls(x) != NIL) push_right(m->ls(x));
+            else {
+                int k = d;
+                uint32_t c;
+                do c = stk[--k]; while (k > 0 && m->ls(stk[k - 1]) == c);
+                if (k == 0) throw invalid_iterator();
+                d = k;
+            }
+            return *this;
+        }
+        const_iterator operator--(int) {
+            const_iterator tmp = *this;
+            --*this;
+            return tmp;
+        }
+        const value_type &operator*() const {
+            if (d == 0) throw invalid_iterator();
+            return m->val(stk[d - 1]);
+        }
+        const value_type *operator->() const {
+            return &**this;
+        }
+        bool operator==(const const_iterator &rhs) const {
+            if (m != rhs.m || d != rhs.d) return false;
+            return d == 0 || stk[d - 1] == rhs.stk[d - 1];
+        }
+        bool operator!=(const const_iterator &rhs) const {
+            return !(*this == rhs);
+        }
+    };
+    class iterator : public const_iterator {
+        friend class compact_map;
+    private:
+        explicit iterator(const compact_map *_m) : const_iterator(_m) {}
+    public:
+        iterator() {}
+        iterator &operator++() {
+            const_iterator::operator++();
+            return *this;
+        }
+        iterator operator++(int) {
+            iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+        iterator &operator--() {
+            const_iterator::operator--();
+            return *this;
+        }
+        iterator operator--(int) {
+            iterator tmp = *this;
+            --*this;
+            return tmp;
+        }
+        value_type &operator*() const {
+            if (this->d == 0) throw invalid_iterator();
+            return this->m->val(this->stk[this->d - 1]);
+        }
+        value_type *operator->() const {
+            return &**this;
+        }
+    };
+
+private:
+    //只找key所在的结点，不记路径，找不到时返回NIL
+    uint32_t locate(const Key &key) const {
+        uint32_t x = rt;
+        while (x != NIL) {
+            int c = compare(key, x);
+            if (c == 0) return x;
+            x = (c < 0 ? ls(x) : rs(x));
+        }
+        return NIL;
+    }
+    //沿key往下走，把路径放进it；找到时it指向它，否则为end()
+    template<class It>
+    It find_path(const Key &key) const {
+        It it(this);
+        uint32_t x = rt;
+        while (x != NIL) {
+            it.stk[it.d++] = x;
+            int c = compare(key, x);
+            if (c == 0) return it;
+            x = (c < 0 ? ls(x) : rs(x));
+        }
+        it.d = 0;
+        return it;
+    }
+    //第一个不小于（upper时为大于）key的元素：路径上最后一个往左走的结点
+    template<class It>
+    It bound_path(const Key &key, bool upper) const {
+        It it(this);
+        int res = 0;
+        uint32_t x = rt;
+        while (x != NIL) {
+            it.stk[it.d++] = x;
+            int c = compare(key, x);
+            if (c < 0 || (c == 0 && !upper)) {
+                res = it.d;
+                x = ls(x);
+            }
+            else x = rs(x);
+        }
+        it.d = res;
+        return it;
+    }
+    template<class It>
+    It path_to(uint32_t target) const {
+        return find_path<It>(val(target).first);
+    }
+    void copy(const compact_map &other) {
+        while (nblocks < other.nblocks) add_block();
+        for (uint32_t x = 0; x < other.used;++x) {
+            slot &s = at_slot(x), &o = other.at_slot(x);
+            if (o.l != FREE) new (s.buf) value_type(*o.val());
+            s.l = o.l;
+            s.r = o.r;
+            //构造失败时destroy只看used以内的槽位
+            used = x + 1;
+        }
+        free_head = other.free_head;
+        rt = other.rt;
+        cur_size = other.cur_size;
+    }
+
+public:
+    compact_map() : nblocks(0), used(0), free_head(NIL), rt(NIL), cur_size(0) {}
+    /**
+     * copies the node array slot by slot, the tree keeps its shape.
+     */
+    compact_map(const compact_map &other) : nblocks(0), used(0), free_head(NIL), rt(NIL), cur_size(0) {
+        try {
+            copy(other);
+        }
+        catch (...) {
+            destroy();
+            throw;
+        }
+    }
+    compact_map(compact_map &&other) noexcept : compact_map() {
+        swap(other);
+    }
+    compact_map &operator=(const compact_map &other) {
+        if (this == &other) return *this;
+        compact_map tmp(other);
+        swap(tmp);
+        return *this;
+    }
+    compact_map &operator=(compact_map &&other) noexcept {
+        if (this == &other) return *this;
+        destroy();
+        swap(other);
+        return *this;
+    }
+    ~compact_map() {
+        destroy();
+    }
+    void swap(compact_map &other) noexcept {
+        for (int i = 0; i < MAX_BLOCKS;++i) std::swap(blocks[i], other.blocks[i]);
+        std::swap(nblocks, other.nblocks);
+        std::swap(used, other.used);
+        std::swap(free_head, other.free_head);
+        std::swap(rt, other.rt);
+        std::swap(cur_size, other.cur_size);
+    }
+    size_t size() const {
+        return cur_size;
+    }
+    bool empty() const {
+        return cur_size == 0;
+    }
+    void clear() {
+        destroy();
+    }
+    /**
+     * allocate the node array in advance for n elements.
+     * throw runtime_error if n is beyond the limit.
+     */
+    void reserve(size_t n) {
+        while (capacity_of(nblocks) < n) add_block();
+    }
+    /**
+     * returns the bytes held by this map: the object itself and its node array, used or not.
+     * memory owned by the keys and values themselves is not counted.
+     */
+    size_t memory_usage() const {
+        return sizeof(*this) + sizeof(slot) * size_t(capacity_of(nblocks));
+    }
+    /**
+     * access specified element with bounds checking
+     * throw index_out_of_bound if such key does not exist.
+     */
+    T &at(const Key &key) {
+        const_iterator it = find_path<const_iterator>(key);
+        if (it.d == 0) throw index_out_of_bound();
+        return val(it.stk[it.d - 1]).second;
+    }
+    const T &at(const Key &key) const {
+        const_iterator it = find_path<const_iterator>(key);
+        if (it.d == 0) throw index_out_of_bound();
+        return val(it.stk[it.d - 1]).second;
+    }
+    /**
+     * performing an insertion if such key does not already exist.
+     */
+    T &operator[](const Key &key) {
+        uint32_t res = locate(key);
+        if (res == NIL) {
+            bool inserted;
+            insert(rt, key, res, inserted, key, T());
+        }
+        return val(res).second;
+    }
+    const T &operator[](const Key &key) const {
+        return at(key);
+    }
+    /**
+     * return a pair, the first of the pair is
+     *   the iterator to the new element (or the element that prevented the insertion),
+     *   the second one is true if insert successfully, or false.
+     * throw runtime_error if the map is full.
+     */
+    pair<iterator, bool> insert(const value_type &value) {
+        uint32_t res;
+        bool inserted;
+        insert(rt, value.first, res, inserted, value);
+        return pair<iterator, bool>(path_to<iterator>(res), inserted);
+    }
+    /**
+     * if key does not exist, insert an element whose mapped value is constructed from args;
+     *   otherwise nothing is constructed and args are left untouched.
+     */
+    template<class... Args>
+    pair<iterator, bool> try_emplace(const Key &key, Args&&... args) {
+        uint32_t res = locate(key);
+        bool inserted = false;
+        if (res == NIL) insert(rt, key, res, inserted, key, T(std::forward<Args>(args)...));
+        return pair<iterator, bool>(path_to<iterator>(res), inserted);
+    }
+    /**
+     * remove the element with key, returns the number of elements removed (0 or 1).
+     */
+    size_t erase(const Key &key) {
+        bool found = false;
+        erase(rt, key, found);
+        return found ? 1 : 0;
+    }
+    /**
+     * throw invalid_iterator if pos is end() or does not belong to this map.
+     */
+    void erase(const_iterator pos) {
+        if (pos.m != this || pos.d == 0) throw invalid_iterator();
+        erase(pos->first);
+    }
+    size_t count(const Key &key) const {
+        return find_path<const_iterator>(key).d == 0 ? 0 : 1;
+    }
+    iterator find(const Key &key) {
+        return find_path<iterator>(key);
+    }
+    const_iterator find(const Key &key) const {
+        return find_path<const_iterator>(key);
+    }
+    /**
+     * returns an iterator to the first element whose key is not less than key,
+     *   or end() if no such element exists.
+     */
+    iterator lower_bound(const Key &key) {
+        return bound_path<iterator>(key, false);
+    }
+    const_iterator lower_bound(const Key &key) const {
+        return bound_path<const_iterator>(key, false);
+    }
+    /**
+     * returns an iterator to the first element whose key is greater than key,
+     *   or end() if no such element exists.
+     */
+    iterator upper_bound(const Key &key) {
+        return bound_path<iterator>(key, true);
+    }
+    const_iterator upper_bound(const Key &key) const {
+        return bound_path<const_iterator>(key, true);
+    }
+    iterator begin() {
+        iterator it(this);
+        it.push_left(rt);
+        return it;
+    }
+    const_iterator cbegin() const {
+        const_iterator it(this);
+        it.push_left(rt);
+        return it;
+    }
+    iterator end() {
+        return iterator(this);
+    }
+    const_iterator cend() const {
+        return const_iterator(this);
+    }
+    /**
+     * returns the height of the tree, 0 when empty.
+     */
+    int height() const {
+        return height(rt);
+    }
+};
+
+template<class Key, class T, class Compare>
+void swap(compact_map<Key, T, Compare> &a, compact_map<Key, T, Compare> &b) noexcept {
+    a.swap(b);
+}
+
+}
+
+#endif
@@ -0,0 +1,338 @@
+#ifndef SJTU_COW_VECTOR_HPP
+#define SJTU_COW_VECTOR_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <utility>
+#include "exceptions.hpp"
+#include "vector.hpp"
+
+namespace sjtu {
+/**
+ * an immutable vector whose copies share one reference counted buffer, so copying is O(1)
+ *   and passing it by value never copies the elements.
+ * every cow_vector sees a prefix [0, size()) of its buffer. push_back constructs the new
+ *   element in place when nobody else has appended to the buffer beyond that prefix yet,
+ *   so pushing onto a fresh copy is still O(1); otherwise the prefix is copied to a new buffer.
+ * other changes (set, pop_back, clear) are applied in place when the buffer is not shared
+ *   and on a private copy when it is. elements are only handed out as const references;
+ *   for many changes in a row use a builder (see transient()), which owns its buffer alone.
+ * the reference counts are atomic, so copies may be used and destroyed in different threads;
+ *   a single cow_vector object is not thread-safe by itself.
+ */
+template<typename T>
+class cow_vector {
+private:
+    //引用计数、已构造的元素个数、容量，元素紧跟在后面
+    class buffer {
+    public:
+        std::atomic<size_t> rc;
+        std::atomic<size_t> used;
+        size_t cap;
+        static size_t offset() {
+            return (sizeof(buffer) + alignof(T) - 1) / alignof(T) * alignof(T);
+        }
+        T *elems() {
+            return reinterpret_cast<T *>(reinterpret_cast<char *>(this) + offset());
+        }
+        static buffer *create(size_t cap) {
+            buffer *b = (buffer *)malloc(offset() + cap * sizeof(T));
+            new (&b->rc) std::atomic<size_t>(1);
+            new (&b->used) std::atomic<size_t>(0);
+            b->cap = cap;
+            return b;
+        }
+        static void release(buffer *b) {
+            if (b == nullptr || b->rc.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+            size_t n = b->used.load(std::memory_order_relaxed);
+            for (size_t i = 0; i < n;++i) b->elems()[i].~T();
+            free(b);
+        }
+    };
+    buffer *buf;
+    size_t len;
+
+    bool shared() const {
+        return buf->rc.load(std::memory_order_acquire) != 1;
+    }
+    //把前len个元素拷到一块容量为cap的新缓冲区，原缓冲区引用计数减一
+    void copy_to(size_t cap) {
+        buffer *b = buffer::create(cap);
+        T *src = buf ? buf->elems() : nullptr, *dst = b->elems();
+        size_t i = 0;
+        try {
+            for (; i < len;++i) new (dst + i) T(src[i]);
+        }
+        catch (...) {
+            b->used.store(i, std::memory_order_relaxed);
+            buffer::release(b);
+            throw;
+        }
+        b->used.store(len, std::memory_order_relaxed);
+        buffer::release(buf);
+        buf = b;
+    }
+    //保证缓冲区只属于自己，并且没有超出len的元素
+    void make_unique() {
+        if (buf == nullptr) return;
+        if (shared()) {
+            copy_to(buf->cap);
+            return;
+        }
+        size_t used = buf->used.load(std::memory_order_relaxed);
+        for (size_t i = len; i < used;++i) buf->elems()[i].~T();
+        buf->used.store(len, std::memory_order_relaxed);
+    }
+    //在缓冲区末尾追加；只有缓冲区已构造到恰好len个元素时才能原地追加
+    template<class V>
+    void append(V &&value) {
+        if (buf != nullptr && len < buf->cap) {
+            //超出len的元素没人用了就先析构掉，省得拷贝
+            if (buf->used.load(std::memory_order_acquire) != len && !shared()) make_unique();
+            size_t expected = len;
+            if (buf->used.compare_exchange_strong(expected, len + 1, std::memory_order_acq_rel)) {
+                try {
+                    new (buf->elems() + len) T(std::forward<V>(value));
+                }
+                catch (...) {
+                    //抢到这个位置之后别人不可能再追加，直接退回去
+                    buf->used.store(len, std::memory_order_release);
+                    throw;
+                }
+                ++len;
+                return;
+            }
+        }
+        //value可能就是旧缓冲区里的元素，先拷出来
+        T tmp(std::forward<V>(value));
+        copy_to(len < 4 ? 8 : 2 * len);
+        new (buf->elems() + len) T(std::move(tmp));
+        buf->used.store(len + 1, std::memory_order_relaxed);
+        ++len;
+    }
+public:
+    typedef const T *const_iterator;
+    typedef const_iterator iterator;
+
+    /**
+     * a mutable vector owning its buffer alone, for building or changing a cow_vector
+     *   without reference count checks on every operation.
+     * persistent() hands the buffer over to a cow_vector in O(1) and leaves the builder empty.
+     */
+    class builder {
+    private:
+        cow_vector v;
+        void grow() {
+            v.copy_to(v.len < 4 ? 8 : 2 * v.len);
+        }
+    public:
+        builder() {}
+        explicit builder(const cow_vector &other) : v(other) {
+            v.make_unique();
+        }
+        builder(const builder &) = delete;
+        builder(builder &&) = default;
+        builder &operator=(const builder &) = delete;
+        builder &operator=(builder &&) = default;
+        size_t size() const {
+            return v.len;
+        }
+        bool empty() const {
+            return v.len == 0;
+        }
+        void reserve(size_t cap) {
+            if (v.buf == nullptr || cap > v.buf->cap) v.copy_to(cap);
+        }
+        /**
+         * throw index_out_of_bound if pos is not in [0, size)
+         */
+        T &operator[](size_t pos) {
+            if (pos >= v.len) throw index_out_of_bound();
+            return v.buf->elems()[pos];
+        }
+        const T &operator[](size_t pos) const {
+            if (pos >= v.len) throw index_out_of_bound();
+            return v.buf->elems()[pos];
+        }
+        T *data() {
+            return v.buf ? v.buf->elems() : nullptr;
+        }
+        void push_back(const T &value) {
+            if (v.buf == nullptr || v.len == v.buf->cap) {
+                T tmp(value);
+                grow();
+                new (v.buf->elems() + v.len) T(std::move(tmp));
+            }
+            else new (v.buf->elems() + v.len) T(value);
+            ++v.len;
+            v.buf->used.store(v.len, std::memory_order_relaxed);
+        }
+        /**
+         * throw container_is_empty if size() == 0
+         */
+        void pop_back() {
+            if (v.len == 0) throw container_is_empty();
+            --v.len;
+            v.buf->elems()[v.len].~T();
+            v.buf->used.store(v.len, std::memory_order_relaxed);
+        }
+        cow_vector persistent() {
+            return std::move(v);
+        }
+    };
+
+    cow_vector() : buf(nullptr), len(0) {}
+    /**
+     * copy the elements of a vector into a new buffer.
+     */
+    explicit cow_vector(const vector<T> &other) : buf(nullptr), len(0) {
+        if (other.empty()) return;
+        buf = buffer::create(other.size());
+        T *dst = buf->elems();
+        try {
+            for (size_t i = 0; i < other.size();++i) {
+                new (dst + i) T(other[i]);
+                buf->used.store(i + 1, std::memory_order_relaxed);
+            }
+        }
+        catch (...) {
+            buffer::release(buf);
+            throw;
+        }
+        len = other.size();
+    }
+    /**
+     * O(1), shares the buffer of other.
+     */
+    cow_vector(const cow_vector &other) : buf(other.buf), len(other.len) {
+        if (buf) buf->rc.fetch_add(1, std::memory_order_relaxed);
+    }
+    cow_vector(cow_vector &&other) noexcept : buf(other.buf), len(other.len) {
+        other.buf = nullptr;
+        other.len = 0;
+    }
+    cow_vector &operator=(cow_vector other) noexcept {
+        swap(other);
+        return *this;
+    }
+    ~cow_vector() {
+        buffer::release(buf);
+    }
+    void swap(cow_vector &other) noexcept {
+        std::swap(buf, other.buf);
+        std::swap(len, other.len);
+    }
+    /**
+     * returns an O(1) copy; later changes to either vector are not seen by the other.
+     */
+    cow_vector snapshot() const {
+        return *this;
+    }
+    /**
+     * returns a builder starting with the elements of this vector.
+     */
+    builder transient() const {
+        return builder(*this);
+    }
+    /**
+     * returns whether no other cow_vector shares the buffer.
+     */
+    bool unique() const {
+        return buf == nullptr || !shared();
+    }
+    size_t size() const {
+        return len;
+    }
+    bool empty() const {
+        return len == 0;
+    }
+    /**
+     * access specified element with bounds checking
+     * throw index_out_of_bound if pos is not in [0, size)
+     */
+    const T &at(const size_t &pos) const {
+        if (pos >= len) throw index_out_of_bound();
+        return buf->elems()[pos];
+    }
+    const T &operator[](const size_t &pos) const {
+        if (pos >= len) throw index_out_of_bound();
+        return buf->elems()[pos];
+    }
+    /**
+     * access the first / last element.
+     * throw container_is_empty if size == 0
+     */
+    const T &front() const {
+        if (len == 0) throw container_is_empty();
+        return buf->elems()[0];
+    }
+    const T &back() const {
+        if (len == 0) throw container_is_empty();
+        return buf->elems()[len - 1];
+    }
+    const T *data() const {
+        return buf ? buf->elems() : nullptr;
+    }
+    const_iterator begin() const {
+        return data();
+    }
+    const_iterator cbegin() const {
+        return data();
+    }
+    const_iterator end() const {
+        return data() + len;
+    }
+    const_iterator cend() const {
+        return data() + len;
+    }
+    void push_back(const T &value) {
+        append(value);
+    }
+    void push_back(T &&value) {
+        append(std::move(value));
+    }
+    /**
+     * remove the last element; a shared buffer is left untouched and only the view shrinks.
+     * throw container_is_empty if size() == 0
+     */
+    void pop_back() {
+        if (len == 0) throw container_is_empty();
+        if (shared()) {
+            --len;
+            return;
+        }
+        make_unique();
+        --len;
+        buf->elems()[len].~T();
+        buf->used.store(len, std::memory_order_relaxed);
+    }
+    /**
+     * replace the element at pos with value.
+     * throw index_out_of_bound if pos is not in [0, size)
+     */
+    void set(const size_t &pos, const T &value) {
+        if (pos >= len) throw index_out_of_bound();
+        if (shared()) {
+            T tmp(value);
+            make_unique();
+            buf->elems()[pos] = std::move(tmp);
+        }
+        else buf->elems()[pos] = value;
+    }
+    void clear() {
+        buffer::release(buf);
+        buf = nullptr;
+        len = 0;
+    }
+};
+
+template<typename T>
+void swap(cow_vector<T> &a, cow_vector<T> &b) noexcept {
+    a.swap(b);
+}
+
+}
+
+#endif
@@ -0,0 +1,438 @@
+#ifndef SJTU_DENSE_MAP_HPP
+#define SJTU_DENSE_MAP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include "utility.hpp"
+#include "exceptions.hpp"
+#include "vector.hpp"
+#include "map.hpp"
+
+namespace sjtu {
+/**
+ * a sorted map for integral keys that are mostly dense, e.g. ids handed out from a counter.
+ * the keys inside a window [lo, lo + window_size()) are stored directly: the value of key k
+ *   is element k - lo of a vector, and a bitmap marks which keys are present. a lookup is
+ *   one subtraction and one bit test, and an element costs sizeof(T) plus one bit.
+ * keys far away from the window (outliers) are kept in a map. the window counts as dense
+ *   while it is no longer than 4 * size() + 64. it doubles towards a key that is at most
+ *   one window size away if it stays dense, and is moved to cover all keys when the
+ *   outliers become as many as the elements in the window while all keys together are
+ *   still dense; outliers inside the new window are moved into it.
+ * iteration is in key order: the outliers below the window, the window by scanning the
+ *   bitmap with ctz, then the outliers above.
+ * T must be default constructible, free slots of the window hold T().
+ * iterators and references are invalidated by every insertion or erasure.
+ */
+template<class Key, class T>
+class dense_map {
+    static_assert(std::is_integral<Key>::value && !std::is_same<Key, bool>::value,
+        "dense_map needs an integral key");
+public:
+    typedef pair<const Key, T> value_type;
+private:
+    typedef typename std::make_unsigned<Key>::type ukey;
+    typedef map<Key, T> outlier_map;
+    static const size_t WORD = 64;
+    static const size_t MIN_WINDOW = 64;
+    //有符号的键翻转最高位，按无符号数比较时顺序不变
+    static const ukey SIGN = std::is_signed<Key>::value ? ukey(ukey(1) << (sizeof(Key) * 8 - 1)) : ukey(0);
+    static const uint64_t MAX_ORD = uint64_t(ukey(-1));
+    //窗口最大的长度，太长的话vector放不下
+    static const uint64_t MAX_WINDOW = sizeof(Key) >= 5 ? (uint64_t(1) << 40) : MAX_ORD + 1;
+
+    uint64_t lo;
+    vector<T> vals;
+    vector<uint64_t> bits;
+    size_t dense_size;
+    outlier_map outliers;
+    //离群点个数到这么多时考虑重新摆放窗口
+    size_t next_check;
+
+    static uint64_t ord(Key k) {
+        return uint64_t(ukey(ukey(k) ^ SIGN));
+    }
+    static Key key_of(uint64_t o) {
+        return Key(ukey(ukey(o) ^ SIGN));
+    }
+    size_t window() const {
+        return vals.size();
+    }
+    //key在窗口里时返回下标，否则返回window()
+    size_t offset(Key k) const {
+        uint64_t o = ord(k);
+        return o >= lo && o - lo < window() ? size_t(o - lo) : window();
+    }
+    bool test(size_t off) const {
+        return bits[off / WORD] >> (off % WORD) & 1;
+    }
+    //下标不小于off的第一个元素，没有时返回window()
+    size_t next_set(size_t off) const {
+        size_t w = off / WORD;
+        if (w >= bits.size()) return window();
+        uint64_t m = bits[w] & (~uint64_t(0) << (off % WORD));
+        while (m == 0) {
+            if (++w == bits.size()) return window();
+            m = bits[w];
+        }
+        return w * WORD + __builtin_ctzll(m);
+    }
+    //最后一个元素的下标，调用前保证窗口里有元素
+    size_t last_set() const {
+        size_t w = bits.size() - 1;
+        while (bits[w] == 0) --w;
+        return w * WORD + 63 - __builtin_clzll(bits[w]);
+    }
+    void set_bit(size_t off) {
+        bits[off / WORD] |= uint64_t(1) << (off % WORD);
+        ++dense_size;
+    }
+    void clear_bit(size_t off) {
+        bits[off / WORD] &= ~(uint64_t(1) << (off % WORD));
+        --dense_size;
+    }
+    //把窗口换成[new_lo, new_lo + len)，原窗口的元素和落进新窗口的离群点都搬过去
+    void relayout(uint64_t new_lo, size_t len) {
+        vector<T> nv;
+        vector<uint64_t> nb;
+        nv.resize(len);
+        nb.resize(len / WORD, 0);
+        for (size_t off = next_set(0); off < window(); off = next_set(off + 1)) {
+            size_t n = size_t(lo + off - new_lo);
+            nv[n] = std::move(vals[off]);
+            nb[n / WORD] |= uint64_t(1) << (n % WORD);
+        }
+        vals.swap(nv);
+        bits.swap(nb);
+        lo = new_lo;
+        typename outlier_map::iterator first = outliers.lower_bound(key_of(lo));
+        typename outlier_map::iterator last = outliers.upper_bound(key_of(lo + len - 1));
+        for (typename outlier_map::iterator it = first; it != last;++it) {
+            size_t n = size_t(ord((*it).first) - lo);
+            vals[n] = std::move((*it).second);
+            set_bit(n);
+        }
+        outliers.erase(first, last);
+    }
+    //长为len的窗口放在不早于start的位置，不能超出键的范围
+    void place(uint64_t start, size_t len) {
+        if (start > MAX_ORD - (len - 1)) start = MAX_ORD - (len - 1);
+        relayout(start, len);
+    }
+    //k不在窗口里：离窗口不超过一个窗口长、加倍后也和recenter一样算稠密时把窗口加倍，返回是否已经覆盖k
+    bool extend(Key k) {
+        uint64_t o = ord(k);
+        if (window() == 0) {
+            place(o / MIN_WINDOW * MIN_WINDOW, MIN_WINDOW);
+            return true;
+        }
+        uint64_t len = window();
+        if (2 * len > 4 * (size() + 1) + MIN_WINDOW || 2 * len > MAX_WINDOW) return false;
+        if (o < lo) {
+            if (lo - o > len) return false;
+            place(lo >= len ? lo - len : 0, size_t(2 * len));
+        }
+        else {
+            if (o - lo - len >= len) return false;
+            place(lo, size_t(2 * len));
+        }
+        return true;
+    }
+    //离群点和窗口里的元素一样多时，看所有键合起来是否还算稠密，是的话让窗口覆盖全部键
+    void recenter() {
+        next_check = 2 * outliers.size() > MIN_WINDOW ? 2 * outliers.size() : MIN_WINDOW;
+        if (outliers.size() < dense_size) return;
+        uint64_t first = ord((*outliers.cbegin()).first), last = ord((*--outliers.cend()).first);
+        if (dense_size) {
+            uint64_t a = lo + next_set(0), b = lo + last_set();
+            if (a < first) first = a;
+            if (b > last) last = b;
+        }
+        uint64_t start = first / WORD * WORD;
+        //键跨满64位时下面加WORD会溢出，先排除
+        if (last - start >= MAX_WINDOW) return;
+        uint64_t len = (last - start) / WORD * WORD + WORD;
+        if (len > 4 * size() + MIN_WINDOW || len > MAX_WINDOW) return;
+        place(start, size_t(len));
+    }
+    //插入一个不存在的键，返回它的值
+    template<class V>
+    T &insert_new(Key k, V &&value) {
+        size_t off = offset(k);
+        if (off == window() && extend(k)) off = offset(k);
+        if (off < window()) {
+            vals[off] = std::forward<V>(value);
+            set_bit(off);
+            return vals[off];
+        }
+        T *res = &(*outliers.insert(value_type(k, std::forward<V>(value))).first).second;
+        if (outliers.size() >= next_check) {
+            recenter();
+            return at(k);
+        }
+        return *res;
+    }
+
+    template<class It, class Self>
+    static It begin_of(Self *self) {
+        It it(self, map_begin(self->outliers), 0, false, false);
+        it.settle();
+        return it;
+    }
+    template<class It, class Self>
+    static It find_in(Self *self, const Key &key) {
+        size_t off = self->offset(key);
+        if (off < self->window()) {
+            if (!self->test(off)) return It(self, map_end(self->outliers), 0, false, true);
+            //窗口之后的离群点从窗口上界开始
+            uint64_t hi = self->lo + self->window() - 1;
+            return It(self, hi >= MAX_ORD ? map_end(self->outliers) : self->outliers.lower_bound(key_of(hi + 1)), off, true, true);
+        }
+        //窗口之前的离群点走完还要进窗口
+        return It(self, self->outliers.find(key), 0, false, ord(key) >= self->lo);
+    }
+    static typename outlier_map::iterator map_begin(outlier_map &m) {
+        return m.begin();
+    }
+    static typename outlier_map::const_iterator map_begin(const outlier_map &m) {
+        return m.cbegin();
+    }
+    static typename outlier_map::iterator map_end(outlier_map &m) {
+        return m.end();
+    }
+    static typename outlier_map::const_iterator map_end(const outlier_map &m) {
+        return m.cend();
+    }
+
+public:
+    /**
+     * a forward iterator in key order; *it is a pair of the key and a reference to the value.
+     */
+    template<bool is_const>
+    class basic_iterator {
+        friend class dense_map;
+        template<bool> friend class basic_iterator;
+    public:
+        typedef typename std::conditional<is_const, const T, T>::type mapped;
+        typedef pair<const Key, mapped &> reference;
+        //operator->的返回值，存着一个reference
+        class arrow {
+        public:
+            reference ref;
+            explicit arrow(const reference &_ref) : ref(_ref) {}
+            const reference *operator->() const {
+                return &ref;
+            }
+        };
+    private:
+        typedef typename std::conditional<is_const, const dense_map, dense_map>::type owner;
+        typedef typename std::conditional<is_const, typename outlier_map::const_iterator,
+            typename outlier_map::iterator>::type map_iterator;
+        owner *dm;
+        //in_window时off为窗口里的下标，否则看mi；mi为end且不在窗口里即为end()
+        map_iterator mi;
+        size_t off;
+        bool in_window, window_done;
+        basic_iterator(owner *_dm, map_iterator _mi, size_t _off, bool _in_window, bool _window_done)
+            : dm(_dm), mi(_mi), off(_off), in_window(_in_window), window_done(_window_done) {}
+        //当前位置不是元素时往后挪到下一个元素
+        void settle() {
+            if (in_window) {
+                off = dm->next_set(off);
+                if (off < dm->window()) return;
+                in_window = false;
+                window_done = true;
+            }
+            if (!window_done && (mi == map_end(dm->outliers) || ord((*mi).first) >= dm->lo)) {
+                off = dm->next_set(0);
+                window_done = true;
+                if (off < dm->window()) in_window = true;
+            }
+        }
+    public:
+        basic_iterator() : dm(nullptr), off(0), in_window(false), window_done(true) {}
+        template<bool c, class = typename std::enable_if<is_const && !c>::type>
+        basic_iterator(const basic_iterator<c> &other)
+            : dm(other.dm), mi(other.mi), off(other.off), in_window(other.in_window), window_done(other.window_done) {}
+        Key key() const {
+            if (dm == nullptr) throw invalid_iterator();
+            if (in_window) return key_of(dm->lo + off);
+            if (mi == map_end(dm->outliers)) throw invalid_iterator();
+            return (*mi).first;
+        }
+        mapped &value() const {
+            if (dm == nullptr) throw invalid_iterator();
+            if (in_window) return dm->vals[off];
+            if (mi == map_end(dm->outliers)) throw invalid_iterator();
+            return (*mi).second;
+        }
+        reference operator*() const {
+            return reference(key(), value());
+        }
+        arrow operator->() const {
+            return arrow(**this);
+        }
+        /**
+         * throw invalid_iterator when moving past the end.
+         */
+        basic_iterator &operator++() {
+            if (dm == nullptr) throw invalid_iterator();
+            if (in_window) ++off;
+            else {
+                if (mi == map_end(dm->outliers)) throw invalid_iterator();
+                ++mi;
+            }
+            settle();
+            return *this;
+        }
+        basic_iterator operator++(int) {
+            basic_iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+        bool operator==(const basic_iterator &rhs) const {
+            if (dm != rhs.dm || in_window != rhs.in_window) return false;
+            return in_window ? off == rhs.off : mi == rhs.mi;
+        }
+        bool operator!=(const basic_iterator &rhs) const {
+            return !(*this == rhs);
+        }
+    };
+    typedef basic_iterator<false> iterator;
+    typedef basic_iterator<true> const_iterator;
+
+    dense_map() : lo(0), dense_size(0), next_check(MIN_WINDOW) {}
+    size_t size() const {
+        return dense_size + outliers.size();
+    }
+    bool empty() const {
+        return size() == 0;
+    }
+    void clear() {
+        vals.clear();
+        bits.clear();
+        dense_size = 0;
+        outliers.clear();
+        next_check = MIN_WINDOW;
+    }
+    /**
+     * returns the number of keys the window covers, present or not.
+     */
+    size_t window_size() const {
+        return window();
+    }
+    /**
+     * returns the number of elements kept outside the window.
+     */
+    size_t outlier_count() const {
+        return outliers.size();
+    }
+    /**
+     * access specified element with bounds checking
+     * throw index_out_of_bound if such key does not exist.
+     */
+    T &at(const Key &key) {
+        size_t off = offset(key);
+        if (off < window()) {
+            if (!test(off)) throw index_out_of_bound();
+            return vals[off];
+        }
+        return outliers.at(key);
+    }
+    const T &at(const Key &key) const {
+        size_t off = offset(key);
+        if (off < window()) {
+            if (!test(off)) throw index_out_of_bound();
+            return vals[off];
+        }
+        return outliers.at(key);
+    }
+    /**
+     * performing an insertion if such key does not already exist.
+     */
+    T &operator[](const Key &key) {
+        size_t off = offset(key);
+        if (off < window() && test(off)) return vals[off];
+        if (off == window() && outliers.count(key)) return outliers.at(key);
+        return insert_new(key, T());
+    }
+    const T &operator[](const Key &key) const {
+        return at(key);
+    }
+    /**
+     * return a pair, the first of the pair is
+     *   the iterator to the new element (or the element that prevented the insertion),
+     *   the second one is true if insert successfully, or false.
+     */
+    pair<iterator, bool> insert(const value_type &value) {
+        bool fresh = count(value.first) == 0;
+        if (fresh) insert_new(value.first, value.second);
+        return pair<iterator, bool>(find(value.first), fresh);
+    }
+    size_t count(const Key &key) const {
+        size_t off = offset(key);
+        if (off < window()) return test(off) ? 1 : 0;
+        return outliers.count(key);
+    }
+    /**
+     * remove the element with key, returns the number of elements removed (0 or 1).
+     */
+    size_t erase(const Key &key) {
+        size_t off = offset(key);
+        if (off < window()) {
+            if (!test(off)) return 0;
+            vals[off] = T();
+            clear_bit(off);
+            return 1;
+        }
+        typename outlier_map::iterator it = outliers.find(key);
+        if (it == outliers.end()) return 0;
+        outliers.erase(it);
+        return 1;
+    }
+    /**
+     * throw invalid_iterator if pos is end() or does not belong to this map.
+     */
+    void erase(const_iterator pos) {
+        if (pos.dm != this) throw invalid_iterator();
+        erase(pos.key());
+    }
+    /**
+     * returns the number of elements whose key is less than key,
+     *   counting the window with popcount a word at a time.
+     */
+    size_t rank(const Key &key) const {
+        size_t res = outliers.rank(key);
+        uint64_t o = ord(key);
+        if (window() == 0 || o <= lo) return res;
+        if (o - lo >= window()) return res + dense_size;
+        size_t off = size_t(o - lo), w = off / WORD;
+        for (size_t i = 0; i < w;++i) res += __builtin_popcountll(bits[i]);
+        if (off % WORD) res += __builtin_popcountll(bits[w] & ((uint64_t(1) << (off % WORD)) - 1));
+        return res;
+    }
+    iterator find(const Key &key) {
+        return find_in<iterator>(this, key);
+    }
+    const_iterator find(const Key &key) const {
+        return find_in<const_iterator>(this, key);
+    }
+    iterator begin() {
+        return begin_of<iterator>(this);
+    }
+    const_iterator cbegin() const {
+        return begin_of<const_iterator>(this);
+    }
+    iterator end() {
+        return iterator(this, outliers.end(), 0, false, true);
+    }
+    const_iterator cend() const {
+        return const_iterator(this, outliers.cend(), 0, false, true);
+    }
+};
+
+}
+
+#endif
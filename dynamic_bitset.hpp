@@ -0,0 +1,248 @@
+#ifndef SJTU_DYNAMIC_BITSET_HPP
+#define SJTU_DYNAMIC_BITSET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include "exceptions.hpp"
+#include "vector.hpp"
+#include "simd_algorithm.hpp"
+
+namespace sjtu {
+/**
+ * a bitset whose size is chosen at run time, stored as 64-bit words.
+ * &=, |=, ^=, subtract and count() go through the word kernels of simd_algorithm.hpp and
+ *   process 256 bits per instruction when AVX2 is available.
+ * the set bits are visited with find_first / find_next, which skip a zero word at a time
+ *   and use ctz inside a word.
+ * the bits past size() in the last word are always zero.
+ */
+class dynamic_bitset {
+private:
+    static const size_t WORD = 64;
+    vector<uint64_t> words;
+    size_t nbits;
+
+    static size_t words_for(size_t n) {
+        return (n + WORD - 1) / WORD;
+    }
+    uint64_t &last_word() {
+        return words[words.size() - 1];
+    }
+    //清掉最后一个字里超出size的位
+    void trim() {
+        if (nbits % WORD) last_word() &= (uint64_t(1) << (nbits % WORD)) - 1;
+    }
+    void check(size_t pos) const {
+        if (pos >= nbits) throw index_out_of_bound();
+    }
+    void check_size(const dynamic_bitset &other) const {
+        if (nbits != other.nbits) throw runtime_error();
+    }
+    //从第w个字起找第一个1
+    size_t scan(size_t w) const {
+        for (;w < words.size();++w)
+            if (words[w]) return w * WORD + __builtin_ctzll(words[w]);
+        return nbits;
+    }
+public:
+    dynamic_bitset() : nbits(0) {}
+    explicit dynamic_bitset(size_t n, bool value = false) : nbits(n) {
+        words.resize(words_for(n), value ? ~uint64_t(0) : 0);
+        trim();
+    }
+    /**
+     * a bitset of size max(ids) + 1 with exactly the bits in ids set; ids may be unsorted
+     *   and contain duplicates.
+     */
+    explicit dynamic_bitset(const vector<uint32_t> &ids) : nbits(0) {
+        for (size_t i = 0; i < ids.size();++i)
+            if (size_t(ids[i]) + 1 > nbits) nbits = size_t(ids[i]) + 1;
+        words.resize(words_for(nbits), 0);
+        for (size_t i = 0; i < ids.size();++i) words[ids[i] / WORD] |= uint64_t(1) << (ids[i] % WORD);
+    }
+
+    size_t size() const {
+        return nbits;
+    }
+    bool empty() const {
+        return nbits == 0;
+    }
+    /**
+     * changes the size to n, new bits are set to value.
+     */
+    void resize(size_t n, bool value = false) {
+        size_t old = nbits;
+        if (value && old % WORD && n > old) last_word() |= ~uint64_t(0) << (old % WORD);
+        words.resize(words_for(n), value ? ~uint64_t(0) : 0);
+        nbits = n;
+        trim();
+    }
+    void push_back(bool value) {
+        if (nbits % WORD == 0) words.push_back(0);
+        if (value) last_word() |= uint64_t(1) << (nbits % WORD);
+        ++nbits;
+    }
+    void clear() {
+        words.clear();
+        nbits = 0;
+    }
+
+    /**
+     * throw index_out_of_bound if pos >= size().
+     */
+    bool test(size_t pos) const {
+        check(pos);
+        return words[pos / WORD] >> (pos % WORD) & 1;
+    }
+    bool operator[](size_t pos) const {
+        return test(pos);
+    }
+    dynamic_bitset &set(size_t pos, bool value = true) {
+        check(pos);
+        if (value) words[pos / WORD] |= uint64_t(1) << (pos % WORD);
+        else words[pos / WORD] &= ~(uint64_t(1) << (pos % WORD));
+        return *this;
+    }
+    dynamic_bitset &reset(size_t pos) {
+        return set(pos, false);
+    }
+    dynamic_bitset &flip(size_t pos) {
+        check(pos);
+        words[pos / WORD] ^= uint64_t(1) << (pos % WORD);
+        return *this;
+    }
+    dynamic_bitset &set() {
+        for (size_t i = 0; i < words.size();++i) words[i] = ~uint64_t(0);
+        trim();
+        return *this;
+    }
+    dynamic_bitset &reset() {
+        for (size_t i = 0; i < words.size();++i) words[i] = 0;
+        return *this;
+    }
+    dynamic_bitset &flip() {
+        for (size_t i = 0; i < words.size();++i) words[i] = ~words[i];
+        trim();
+        return *this;
+    }
+
+    /**
+     * the number of set bits.
+     */
+    size_t count() const {
+        return simd::popcount(words.data(), words.size());
+    }
+    bool any() const {
+        return scan(0) != nbits;
+    }
+    bool none() const {
+        return !any();
+    }
+    bool all() const {
+        return count() == nbits;
+    }
+
+    /**
+     * the set operations need both bitsets to have the same size.
+     * throw runtime_error otherwise.
+     */
+    dynamic_bitset &operator&=(const dynamic_bitset &other) {
+        check_size(other);
+        simd::bit_and(words.data(), other.words.data(), words.size());
+        return *this;
+    }
+    dynamic_bitset &operator|=(const dynamic_bitset &other) {
+        check_size(other);
+        simd::bit_or(words.data(), other.words.data(), words.size());
+        return *this;
+    }
+    dynamic_bitset &operator^=(const dynamic_bitset &other) {
+        check_size(other);
+        simd::bit_xor(words.data(), other.words.data(), words.size());
+        return *this;
+    }
+    /**
+     * clears every bit that is set in other (*this &= ~other).
+     */
+    dynamic_bitset &subtract(const dynamic_bitset &other) {
+        check_size(other);
+        simd::bit_andnot(words.data(), other.words.data(), words.size());
+        return *this;
+    }
+    dynamic_bitset operator~() const {
+        dynamic_bitset res(*this);
+        res.flip();
+        return res;
+    }
+    bool operator==(const dynamic_bitset &other) const {
+        if (nbits != other.nbits) return false;
+        for (size_t i = 0; i < words.size();++i)
+            if (words[i] != other.words[i]) return false;
+        return true;
+    }
+    bool operator!=(const dynamic_bitset &other) const {
+        return !(*this == other);
+    }
+
+    /**
+     * the position of the first set bit, size() if there is none.
+     */
+    size_t find_first() const {
+        return scan(0);
+    }
+    /**
+     * the position of the first set bit after pos, size() if there is none.
+     */
+    size_t find_next(size_t pos) const {
+        if (++pos >= nbits) return nbits;
+        uint64_t w = words[pos / WORD] & (~uint64_t(0) << (pos % WORD));
+        if (w) return pos / WORD * WORD + __builtin_ctzll(w);
+        return scan(pos / WORD + 1);
+    }
+    /**
+     * calls f(pos) for every set bit in increasing order.
+     */
+    template<class F>
+    void for_each(F f) const {
+        for (size_t i = 0; i < words.size();++i)
+            for (uint64_t w = words[i]; w; w &= w - 1) f(i * WORD + __builtin_ctzll(w));
+    }
+    /**
+     * the positions of the set bits in increasing order.
+     */
+    vector<uint32_t> to_vector() const {
+        vector<uint32_t> res;
+        res.reserve(count());
+        for (size_t i = 0; i < words.size();++i)
+            for (uint64_t w = words[i]; w; w &= w - 1) res.push_back(uint32_t(i * WORD + __builtin_ctzll(w)));
+        return res;
+    }
+
+    const uint64_t *data() const {
+        return words.data();
+    }
+    size_t num_words() const {
+        return words.size();
+    }
+    size_t memory_usage() const {
+        return sizeof(*this) + words.capacity() * sizeof(uint64_t);
+    }
+    void swap(dynamic_bitset &other) {
+        words.swap(other.words);
+        size_t t = nbits; nbits = other.nbits; other.nbits = t;
+    }
+};
+
+inline dynamic_bitset operator&(dynamic_bitset a, const dynamic_bitset &b) {
+    return a &= b;
+}
+inline dynamic_bitset operator|(dynamic_bitset a, const dynamic_bitset &b) {
+    return a |= b;
+}
+inline dynamic_bitset operator^(dynamic_bitset a, const dynamic_bitset &b) {
+    return a ^= b;
+}
+
+}
+
+#endif
@@ -0,0 +1,275 @@
+#ifndef SJTU_FROZEN_MAP_HPP
+#define SJTU_FROZEN_MAP_HPP
+
+#include <cstddef>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <utility>
+#include "utility.hpp"
+#include "exceptions.hpp"
+#include "map.hpp"
+
+namespace sjtu {
+/**
+ * an immutable sorted map built once from a map (see map::freeze) and then only queried.
+ * the keys are stored in one array in Eytzinger (BFS) order: the children of slot k are
+ *   slots 2k and 2k+1, so a search walks down a perfectly balanced implicit tree touching
+ *   one array, and the next levels can be prefetched before they are needed.
+ * the mapped values live in a parallel array and are only touched once the key is found.
+ * compared with map there are no per-element pointers or heights and no separate allocation
+ *   per element.
+ * iterating goes through the elements in key order; iterators are never invalidated.
+ */
+template<class Key, class T, class Compare = std::less<Key>>
+class frozen_map {
+public:
+    //元素分开存放，解引用得到的是对键和值的引用组成的pair
+    typedef pair<const Key &, const T &> reference;
+private:
+    //下标从1开始，keys[0]和vals[0]不用
+    Key *keys;
+    T *vals;
+    size_t n;
+
+    //一次预取覆盖之后第几层，按一个cache line能放下的键数算
+    static const size_t PREFETCH_STRIDE = 64 / sizeof(Key) ? 64 / sizeof(Key) : 1;
+
+    void allocate(size_t _n) {
+        n = _n;
+        keys = (Key *)malloc((n + 1) * sizeof(Key));
+        vals = (T *)malloc((n + 1) * sizeof(T));
+    }
+    void release() {
+        for (size_t k = 1; k <= n;++k) {
+            keys[k].~Key();
+            vals[k].~T();
+        }
+        free(keys);
+        free(vals);
+    }
+    //按中序把有序的元素依次填进隐式树
+    template<class Iterator>
+    void fill(size_t k, Iterator &it) {
+        if (k > n) return;
+        fill(2 * k, it);
+        new (keys + k) Key(it->first);
+        new (vals + k) T(it->second);
+        ++it;
+        fill(2 * k + 1, it);
+    }
+    //隐式树上的中序后继和前驱，没有时返回0
+    size_t first_slot() const {
+        if (n == 0) return 0;
+        size_t k = 1;
+        while (2 * k <= n) k = 2 * k;
+        return k;
+    }
+    size_t last_slot() const {
+        if (n == 0) return 0;
+        size_t k = 1;
+        while (2 * k + 1 <= n) k = 2 * k + 1;
+        return k;
+    }
+    size_t next_slot(size_t k) const {
+        if (2 * k + 1 <= n) {
+            k = 2 * k + 1;
+            while (2 * k <= n) k = 2 * k;
+            return k;
+        }
+        //一路向上直到从左孩子上来
+        while (k & 1) k >>= 1;
+        return k >> 1;
+    }
+    size_t prev_slot(size_t k) const {
+        if (2 * k <= n) {
+            k = 2 * k;
+            while (2 * k + 1 <= n) k = 2 * k + 1;
+            return k;
+        }
+        while (k > 1 && !(k & 1)) k >>= 1;
+        return k >> 1;
+    }
+    //沿隐式树往下走，每层按比较结果选孩子，不分支；走出树后去掉末尾的1和最后一个0，
+    //剩下的就是最后一次往左走时所在的结点，即第一个满足!go_right的位置
+    template<class GoRight>
+    size_t descend(GoRight go_right) const {
+        size_t k = 1;
+        while (k <= n) {
+#if defined(__GNUC__)
+            __builtin_prefetch(keys + (k * PREFETCH_STRIDE <= n ? k * PREFETCH_STRIDE : 0));
+#endif
+            k = 2 * k + go_right(keys[k]);
+        }
+        k >>= __builtin_ctzll(~(unsigned long long)k) + 1;
+        return k;
+    }
+public:
+    class const_iterator {
+        friend class frozen_map;
+    private:
+        const frozen_map *fm;
+        //0表示end
+        size_t k;
+        const_iterator(const frozen_map *_fm, size_t _k) : fm(_fm), k(_k) {}
+    public:
+        //operator->的返回值，存着一个reference
+        class arrow {
+        public:
+            reference ref;
+            explicit arrow(const reference &_ref) : ref(_ref) {}
+            const reference *operator->() const {
+                return &ref;
+            }
+        };
+        const_iterator() : fm(nullptr), k(0) {}
+        const Key &key() const {
+            if (fm == nullptr || k == 0) throw invalid_iterator();
+            return fm->keys[k];
+        }
+        const T &value() const {
+            if (fm == nullptr || k == 0) throw invalid_iterator();
+            return fm->vals[k];
+        }
+        reference operator*() const {
+            return reference(key(), value());
+        }
+        arrow operator->() const {
+            return arrow(**this);
+        }
+        /**
+         * throw invalid_iterator when moving past the end or before the beginning.
+         */
+        const_iterator &operator++() {
+            if (fm == nullptr || k == 0) throw invalid_iterator();
+            k = fm->next_slot(k);
+            return *this;
+        }
+        const_iterator operator++(int) {
+            const_iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+        const_iterator &operator--() {
+            if (fm == nullptr) throw invalid_iterator();
+            size_t p = (k == 0 ? fm->last_slot() : fm->prev_slot(k));
+            if (p == 0) throw invalid_iterator();
+            k = p;
+            return *this;
+        }
+        const_iterator operator--(int) {
+            const_iterator tmp = *this;
+            --*this;
+            return tmp;
+        }
+        bool operator==(const const_iterator &rhs) const {
+            return fm == rhs.fm && k == rhs.k;
+        }
+        bool operator!=(const const_iterator &rhs) const {
+            return !(*this == rhs);
+        }
+    };
+    typedef const_iterator iterator;
+
+    frozen_map() : keys(nullptr), vals(nullptr), n(0) {}
+    /**
+     * copy the elements of m, in O(size()).
+     */
+    explicit frozen_map(const map<Key, T, Compare> &m) {
+        allocate(m.size());
+        typename map<Key, T, Compare>::const_iterator it = m.cbegin();
+        fill(1, it);
+    }
+    frozen_map(const frozen_map &other) {
+        allocate(other.n);
+        for (size_t k = 1; k <= n;++k) {
+            new (keys + k) Key(other.keys[k]);
+            new (vals + k) T(other.vals[k]);
+        }
+    }
+    frozen_map(frozen_map &&other) noexcept : keys(other.keys), vals(other.vals), n(other.n) {
+        other.keys = nullptr;
+        other.vals = nullptr;
+        other.n = 0;
+    }
+    frozen_map &operator=(frozen_map other) noexcept {
+        swap(other);
+        return *this;
+    }
+    ~frozen_map() {
+        release();
+    }
+    void swap(frozen_map &other) noexcept {
+        std::swap(keys, other.keys);
+        std::swap(vals, other.vals);
+        std::swap(n, other.n);
+    }
+    size_t size() const {
+        return n;
+    }
+    bool empty() const {
+        return n == 0;
+    }
+    const_iterator begin() const {
+        return const_iterator(this, first_slot());
+    }
+    const_iterator cbegin() const {
+        return begin();
+    }
+    const_iterator end() const {
+        return const_iterator(this, 0);
+    }
+    const_iterator cend() const {
+        return end();
+    }
+    /**
+     * returns an iterator to the first element whose key is not less than key, or end().
+     */
+    const_iterator lower_bound(const Key &key) const {
+        Compare cmp;
+        return const_iterator(this, descend([&](const Key &x) { return cmp(x, key); }));
+    }
+    /**
+     * returns an iterator to the first element whose key is greater than key, or end().
+     */
+    const_iterator upper_bound(const Key &key) const {
+        Compare cmp;
+        return const_iterator(this, descend([&](const Key &x) { return !cmp(key, x); }));
+    }
+    /**
+     * returns an iterator to the element with key, or end() if it does not exist.
+     */
+    const_iterator find(const Key &key) const {
+        size_t k = descend([&](const Key &x) { return Compare()(x, key); });
+        if (k == 0 || Compare()(key, keys[k])) return end();
+        return const_iterator(this, k);
+    }
+    size_t count(const Key &key) const {
+        return find(key) == end() ? 0 : 1;
+    }
+    /**
+     * throw index_out_of_bound if key does not exist.
+     */
+    const T &at(const Key &key) const {
+        const_iterator it = find(key);
+        if (it == end()) throw index_out_of_bound();
+        return vals[it.k];
+    }
+    const T &operator[](const Key &key) const {
+        return at(key);
+    }
+};
+
+template<class Key, class T, class Compare>
+void swap(frozen_map<Key, T, Compare> &a, frozen_map<Key, T, Compare> &b) noexcept {
+    a.swap(b);
+}
+
+template<class Key, class T, class Compare>
+frozen_map<Key, T, Compare> map<Key, T, Compare>::freeze() const {
+    return frozen_map<Key, T, Compare>(*this);
+}
+
+}
+
+#endif
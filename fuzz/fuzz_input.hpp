@@ -0,0 +1,106 @@
+#ifndef SJTU_FUZZ_INPUT_HPP
+#define SJTU_FUZZ_INPUT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+/**
+ * support code shared by the differential fuzz targets in this directory.
+ * each target defines LLVMFuzzerTestOneInput, which decodes the input bytes into a sequence of
+ *   operations, applies every operation both to a sjtu container and to the equivalent std
+ *   container, and aborts as soon as a result, a thrown exception or the contents differ.
+ * build one with libFuzzer (the support headers of the tree must be on the include path):
+ *   clang++ -std=c++14 -g -O1 -fsanitize=fuzzer,address,undefined -I.. fuzz_map.cpp -o fuzz_map
+ *   ./fuzz_map corpus/
+ * without libFuzzer, -DSJTU_FUZZ_MAIN adds a main() that replays the files given on the
+ *   command line, or runs pseudo-random inputs when there are none:
+ *   g++ -std=c++14 -g -O1 -fsanitize=address,undefined -DSJTU_FUZZ_MAIN -I.. fuzz_map.cpp
+ */
+namespace sjtu_fuzz {
+
+//按顺序读输入的字节，读完之后一直返回0
+class input {
+private:
+    const uint8_t *p;
+    size_t left;
+public:
+    input(const uint8_t *data, size_t size) : p(data), left(size) {}
+    bool empty() const {
+        return left == 0;
+    }
+    uint8_t byte() {
+        if (left == 0) return 0;
+        --left;
+        return *p++;
+    }
+    //键只取很小的范围，插入、查找和删除才会经常碰到同一个元素
+    int key() {
+        return byte() % 64;
+    }
+    int value() {
+        return int16_t(uint16_t(byte()) << 8 | byte());
+    }
+    //[0, n]中的一个位置
+    size_t position(size_t n) {
+        return (size_t(byte()) << 8 | byte()) % (n + 1);
+    }
+};
+
+inline void fail(const char *cond, const char *file, int line) {
+    fprintf(stderr, "%s:%d: check failed: %s\n", file, line, cond);
+    abort();
+}
+
+}
+
+#define FUZZ_CHECK(cond) \
+    do { if (!(cond)) sjtu_fuzz::fail(#cond, __FILE__, __LINE__); } while (0)
+//expr必须抛出exc，不能抛别的异常，也不能不抛
+#define FUZZ_THROWS(expr, exc) \
+    do { \
+        bool caught_ = false; \
+        try { expr; } catch (exc &) { caught_ = true; } \
+        if (!caught_) sjtu_fuzz::fail(#expr " throws " #exc, __FILE__, __LINE__); \
+    } while (0)
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+#ifdef SJTU_FUZZ_MAIN
+int main(int argc, char **argv) {
+    if (argc > 1) {
+        for (int i = 1; i < argc;++i) {
+            FILE *f = fopen(argv[i], "rb");
+            if (!f) {
+                fprintf(stderr, "cannot open %s\n", argv[i]);
+                return 1;
+            }
+            std::vector<uint8_t> buf;
+            int c;
+            while ((c = fgetc(f)) != EOF) buf.push_back(uint8_t(c));
+            fclose(f);
+            LLVMFuzzerTestOneInput(buf.data(), buf.size());
+        }
+        return 0;
+    }
+    //没有给文件时跑固定种子的随机输入，长短不一
+    const int RUNS = 2000;
+    uint64_t s = 0x9e3779b97f4a7c15ULL;
+    std::vector<uint8_t> buf;
+    for (int run = 0; run < RUNS;++run) {
+        s ^= s << 13, s ^= s >> 7, s ^= s << 17;
+        buf.resize(s % 4096);
+        for (size_t i = 0; i < buf.size();++i) {
+            s ^= s << 13, s ^= s >> 7, s ^= s << 17;
+            buf[i] = uint8_t(s >> 24);
+        }
+        LLVMFuzzerTestOneInput(buf.data(), buf.size());
+    }
+    printf("%d random inputs passed\n", RUNS);
+    return 0;
+}
+#endif
+
+#endif
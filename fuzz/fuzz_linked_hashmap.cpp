@@ -0,0 +1,179 @@
+/*
+ * differential fuzz target: sjtu::linked_hashmap against std::unordered_map plus a std::list
+ *   of the keys in insertion order.
+ */
+#include <algorithm>
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include "fuzz_input.hpp"
+#include "../linked_hashmap.hpp"
+
+namespace {
+
+typedef sjtu::linked_hashmap<int, int> hm;
+
+class reference {
+public:
+    std::unordered_map<int, int> vals;
+    std::list<int> order;
+    //新键排到最后，已有的键位置不变；返回是否插入了
+    bool insert(int k, int v, bool assign) {
+        std::pair<std::unordered_map<int, int>::iterator, bool> p = vals.insert(std::make_pair(k, v));
+        if (p.second) order.push_back(k);
+        else if (assign) p.first->second = v;
+        return p.second;
+    }
+    void erase(int k) {
+        vals.erase(k);
+        order.erase(std::find(order.begin(), order.end(), k));
+    }
+    void clear() {
+        vals.clear();
+        order.clear();
+    }
+};
+
+//按插入顺序正着、倒着各走一遍
+void same(const hm &m, const reference &r) {
+    FUZZ_CHECK(m.size() == r.vals.size());
+    FUZZ_CHECK(m.empty() == r.vals.empty());
+    hm::const_iterator it = m.cbegin();
+    for (std::list<int>::const_iterator j = r.order.begin(); j != r.order.end();++j, ++it) {
+        FUZZ_CHECK(it != m.cend());
+        FUZZ_CHECK((*it).first == *j && (*it).second == r.vals.at(*j));
+    }
+    FUZZ_CHECK(it == m.cend());
+    for (std::list<int>::const_reverse_iterator j = r.order.rbegin(); j != r.order.rend();++j)
+        FUZZ_CHECK((*--it).first == *j);
+}
+//每个桶里的元素加起来要等于size()，要扫整张表，只在表变了以后查
+void same_buckets(const hm &m) {
+    size_t total = 0;
+    for (size_t b = 0; b < m.bucket_count();++b) total += m.bucket_size(b);
+    FUZZ_CHECK(total == m.size());
+}
+
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    sjtu_fuzz::input in(data, size);
+    hm m;
+    reference r;
+    while (!in.empty()) {
+        switch (in.byte() % 13) {
+        case 0: {
+            int k = in.key(), v = in.value();
+            m[k] = v;
+            r.insert(k, v, true);
+            break;
+        }
+        case 1: {
+            int k = in.key(), v = in.value();
+            sjtu::pair<hm::iterator, bool> p = m.insert(hm::value_type(k, v));
+            FUZZ_CHECK(p.second == r.insert(k, v, false));
+            FUZZ_CHECK((*p.first).first == k && (*p.first).second == r.vals.at(k));
+            break;
+        }
+        case 2: {
+            int k = in.key(), v = in.value();
+            sjtu::pair<hm::iterator, bool> p = m.emplace(k, v);
+            FUZZ_CHECK(p.second == r.insert(k, v, false));
+            break;
+        }
+        case 3: {
+            int k = in.key(), v = in.value();
+            sjtu::pair<hm::iterator, bool> p = m.try_emplace(k, v);
+            FUZZ_CHECK(p.second == r.insert(k, v, false));
+            FUZZ_CHECK((*p.first).second == r.vals.at(k));
+            break;
+        }
+        case 4: {
+            int k = in.key(), v = in.value();
+            sjtu::pair<hm::iterator, bool> p = m.insert_or_assign(k, v);
+            FUZZ_CHECK(p.second == r.insert(k, v, true));
+            FUZZ_CHECK((*p.first).second == v);
+            break;
+        }
+        case 5: {
+            int k = in.key();
+            hm::iterator it = m.find(k);
+            if (r.vals.count(k)) {
+                m.erase(it);
+                r.erase(k);
+            }
+            else {
+                FUZZ_CHECK(it == m.end());
+                FUZZ_THROWS(m.erase(it), sjtu::invalid_iterator);
+            }
+            break;
+        }
+        case 6: {
+            //const版本的find找不到时也要返回cend()
+            int k = in.key();
+            const hm &cm = m;
+            FUZZ_CHECK(m.count(k) == r.vals.count(k));
+            FUZZ_CHECK((cm.find(k) == cm.cend()) == !r.vals.count(k));
+            if (r.vals.count(k)) FUZZ_CHECK(m.at(k) == r.vals.at(k) && cm.at(k) == r.vals.at(k));
+            else {
+                FUZZ_THROWS(m.at(k), sjtu::index_out_of_bound);
+                FUZZ_THROWS(cm.at(k), sjtu::index_out_of_bound);
+            }
+            break;
+        }
+        case 7: {
+            hm o;
+            o[in.key()] = 1;
+            FUZZ_THROWS(m.erase(o.begin()), sjtu::invalid_iterator);
+            FUZZ_THROWS(m.erase(m.end()), sjtu::invalid_iterator);
+            break;
+        }
+        case 8: {
+            hm c(m);
+            same(c, r);
+            hm d;
+            d[in.key()] = 0;
+            d = c;
+            hm e(std::move(c));
+            FUZZ_CHECK(c.empty() && c.find(0) == c.end());
+            same(e, r);
+            same_buckets(e);
+            c[1] = 1;
+            FUZZ_CHECK(c.size() == 1);
+            m = std::move(d);
+            break;
+        }
+        case 9: {
+            hm o;
+            o[in.key()] = in.value();
+            m.swap(o);
+            swap(m, o);
+            break;
+        }
+        case 10:
+            m.reserve(in.byte() % 128);
+            same_buckets(m);
+            break;
+        case 11:
+            if (in.byte() % 8 == 0) {
+                m.clear();
+                r.clear();
+            }
+            break;
+        case 12: {
+            //迭代器改值不影响顺序
+            if (r.order.empty()) break;
+            size_t i = in.position(r.order.size() - 1);
+            hm::iterator it = m.begin();
+            for (size_t j = 0; j < i;++j) ++it;
+            int v = in.value();
+            (*it).second = v;
+            r.vals[(*it).first] = v;
+            break;
+        }
+        }
+        same(m, r);
+    }
+    same_buckets(m);
+    return 0;
+}
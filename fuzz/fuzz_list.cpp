@@ -0,0 +1,169 @@
+/*
+ * differential fuzz target: sjtu::list against std::list.
+ */
+#include <iterator>
+#include <list>
+#include <utility>
+#include "fuzz_input.hpp"
+#include "../list.hpp"
+
+namespace {
+
+typedef sjtu::list<int> lst;
+
+lst::iterator nth(lst &l, size_t n) {
+    lst::iterator it = l.begin();
+    while (n--) ++it;
+    return it;
+}
+std::list<int>::iterator nth(std::list<int> &r, size_t n) {
+    std::list<int>::iterator it = r.begin();
+    std::advance(it, n);
+    return it;
+}
+
+//正着、倒着各走一遍，--end()也要能回到最后一个元素
+void same(const lst &l, const std::list<int> &r) {
+    FUZZ_CHECK(l.size() == r.size());
+    FUZZ_CHECK(l.empty() == r.empty());
+    lst::const_iterator it = l.cbegin();
+    for (std::list<int>::const_iterator j = r.begin(); j != r.end();++j, ++it) {
+        FUZZ_CHECK(it != l.cend());
+        FUZZ_CHECK(*it == *j);
+    }
+    FUZZ_CHECK(it == l.cend());
+    for (std::list<int>::const_reverse_iterator j = r.rbegin(); j != r.rend();++j) FUZZ_CHECK(*--it == *j);
+    FUZZ_CHECK(it == l.cbegin());
+    if (!r.empty()) {
+        FUZZ_CHECK(l.front() == r.front());
+        FUZZ_CHECK(l.back() == r.back());
+    }
+}
+
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    sjtu_fuzz::input in(data, size);
+    lst l;
+    std::list<int> r;
+    while (!in.empty()) {
+        switch (in.byte() % 13) {
+        case 0: {
+            int x = in.key();
+            l.push_back(x);
+            r.push_back(x);
+            break;
+        }
+        case 1: {
+            int x = in.key();
+            l.push_front(x);
+            r.push_front(x);
+            break;
+        }
+        case 2:
+            if (r.empty()) {
+                FUZZ_THROWS(l.pop_back(), sjtu::container_is_empty);
+                FUZZ_THROWS(l.pop_front(), sjtu::container_is_empty);
+            }
+            else if (in.byte() % 2) {
+                l.pop_back();
+                r.pop_back();
+            }
+            else {
+                l.pop_front();
+                r.pop_front();
+            }
+            break;
+        case 3: {
+            size_t i = in.position(r.size());
+            int x = in.key();
+            FUZZ_CHECK(*l.insert(nth(l, i), x) == x);
+            r.insert(nth(r, i), x);
+            break;
+        }
+        case 4: {
+            size_t i = in.position(r.size());
+            if (r.empty()) FUZZ_THROWS(l.erase(l.begin()), sjtu::container_is_empty);
+            else if (i == r.size()) FUZZ_THROWS(l.erase(l.end()), sjtu::invalid_iterator);
+            else {
+                lst::iterator it = l.erase(nth(l, i));
+                std::list<int>::iterator j = r.erase(nth(r, i));
+                FUZZ_CHECK((it == l.end()) == (j == r.end()));
+                if (j != r.end()) FUZZ_CHECK(*it == *j);
+            }
+            break;
+        }
+        case 5: {
+            //别的list的迭代器不能用
+            lst o;
+            o.push_back(1);
+            FUZZ_THROWS(l.insert(o.begin(), 2), sjtu::invalid_iterator);
+            if (!r.empty()) FUZZ_THROWS(l.erase(o.begin()), sjtu::invalid_iterator);
+            break;
+        }
+        case 6:
+            if (r.empty()) {
+                FUZZ_THROWS(l.front(), sjtu::container_is_empty);
+                FUZZ_THROWS(l.back(), sjtu::container_is_empty);
+            }
+            break;
+        case 7:
+            l.sort();
+            r.sort();
+            break;
+        case 8: {
+            //两边都有序时合并，相等的元素本身的在前
+            lst o;
+            std::list<int> ro;
+            for (int n = in.byte() % 16; n > 0;--n) {
+                int x = in.key();
+                o.push_back(x);
+                ro.push_back(x);
+            }
+            l.sort();
+            r.sort();
+            o.sort();
+            ro.sort();
+            l.merge(o);
+            r.merge(ro);
+            FUZZ_CHECK(o.empty());
+            break;
+        }
+        case 9:
+            l.reverse();
+            r.reverse();
+            break;
+        case 10:
+            l.unique();
+            r.unique();
+            break;
+        case 11: {
+            lst c(l);
+            same(c, r);
+            lst d;
+            d.push_back(in.key());
+            d = c;
+            lst e(std::move(c));
+            FUZZ_CHECK(c.empty());
+            same(e, r);
+            e.reverse();
+            l = std::move(d);
+            break;
+        }
+        case 12:
+            if (in.byte() % 8 == 0) {
+                l.clear();
+                r.clear();
+            }
+            else {
+                lst o;
+                o.push_back(in.key());
+                l.swap(o);
+                swap(l, o);
+            }
+            break;
+        }
+        same(l, r);
+    }
+    return 0;
+}
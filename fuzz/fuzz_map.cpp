@@ -0,0 +1,187 @@
+/*
+ * differential fuzz target: sjtu::map against std::map.
+ */
+#include <iterator>
+#include <map>
+#include <utility>
+#include <vector>
+#include "fuzz_input.hpp"
+#include "../map.hpp"
+
+namespace {
+
+typedef sjtu::map<int, int> mp;
+typedef std::map<int, int> ref;
+
+//正着走到end()，再倒着走回begin()；两头再往外走都要抛异常
+void same(const mp &m, const ref &r) {
+    FUZZ_CHECK(m.size() == r.size());
+    FUZZ_CHECK(m.empty() == r.empty());
+    mp::const_iterator it = m.cbegin();
+    size_t i = 0;
+    for (ref::const_iterator j = r.begin(); j != r.end();++j, ++it, ++i) {
+        FUZZ_CHECK(it != m.cend());
+        FUZZ_CHECK((*it).first == j->first && (*it).second == j->second);
+        FUZZ_CHECK(m.rank(j->first) == i);
+    }
+    FUZZ_CHECK(it == m.cend());
+    FUZZ_THROWS(++it, sjtu::invalid_iterator);
+    for (ref::const_reverse_iterator j = r.rbegin(); j != r.rend();++j) FUZZ_CHECK((*--it).first == j->first);
+    FUZZ_CHECK(it == m.cbegin());
+    FUZZ_THROWS(--it, sjtu::invalid_iterator);
+}
+
+mp::iterator nth(mp &m, size_t n) {
+    mp::iterator it = m.begin();
+    while (n--) ++it;
+    return it;
+}
+
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    sjtu_fuzz::input in(data, size);
+    mp m;
+    ref r;
+    while (!in.empty()) {
+        switch (in.byte() % 14) {
+        case 0: {
+            int k = in.key(), v = in.value();
+            m[k] = v;
+            r[k] = v;
+            break;
+        }
+        case 1: {
+            int k = in.key(), v = in.value();
+            sjtu::pair<mp::iterator, bool> p = m.insert(mp::value_type(k, v));
+            std::pair<ref::iterator, bool> q = r.insert(ref::value_type(k, v));
+            FUZZ_CHECK(p.second == q.second);
+            FUZZ_CHECK((*p.first).first == k && (*p.first).second == q.first->second);
+            break;
+        }
+        case 2: {
+            int k = in.key();
+            mp::iterator it = m.find(k);
+            if (r.count(k)) {
+                m.erase(it);
+                r.erase(k);
+            }
+            else {
+                FUZZ_CHECK(it == m.end());
+                FUZZ_THROWS(m.erase(it), sjtu::invalid_iterator);
+            }
+            break;
+        }
+        case 3: {
+            int k = in.key();
+            const mp &cm = m;
+            FUZZ_CHECK(m.count(k) == r.count(k));
+            FUZZ_CHECK((cm.find(k) == cm.cend()) == (r.find(k) == r.end()));
+            if (r.count(k)) FUZZ_CHECK(m.at(k) == r.at(k) && cm.at(k) == r.at(k));
+            else {
+                FUZZ_THROWS(m.at(k), sjtu::index_out_of_bound);
+                FUZZ_THROWS(cm.at(k), sjtu::index_out_of_bound);
+            }
+            break;
+        }
+        case 4: {
+            int k = in.key();
+            mp::iterator lo = m.lower_bound(k), hi = m.upper_bound(k);
+            ref::iterator rlo = r.lower_bound(k), rhi = r.upper_bound(k);
+            FUZZ_CHECK((lo == m.end()) == (rlo == r.end()));
+            if (rlo != r.end()) FUZZ_CHECK((*lo).first == rlo->first);
+            FUZZ_CHECK((hi == m.end()) == (rhi == r.end()));
+            if (rhi != r.end()) FUZZ_CHECK((*hi).first == rhi->first);
+            break;
+        }
+        case 5: {
+            size_t i = in.position(r.size());
+            if (i == r.size()) FUZZ_THROWS(m.select(i), sjtu::index_out_of_bound);
+            else FUZZ_CHECK((*m.select(i)).first == std::next(r.begin(), i)->first);
+            break;
+        }
+        case 6: {
+            //区间倒过来时必须抛异常，而且一个元素都不能删
+            size_t i = in.position(r.size()), j = in.position(r.size());
+            if (i > j) FUZZ_THROWS(m.erase(nth(m, i), nth(m, j)), sjtu::invalid_iterator);
+            else {
+                mp::iterator it = m.erase(nth(m, i), nth(m, j));
+                ref::iterator rt = r.erase(std::next(r.begin(), i), std::next(r.begin(), j));
+                FUZZ_CHECK((it == m.end()) == (rt == r.end()));
+            }
+            break;
+        }
+        case 7: {
+            mp o;
+            o[in.key()] = 1;
+            FUZZ_THROWS(m.erase(o.begin()), sjtu::invalid_iterator);
+            FUZZ_THROWS(m.erase(m.end()), sjtu::invalid_iterator);
+            FUZZ_THROWS(*m.end(), sjtu::invalid_iterator);
+            break;
+        }
+        case 8: {
+            //有序的一段整体插入，乱序时退回逐个插入
+            std::vector<sjtu::pair<const int, int> > src;
+            bool sorted = in.byte() % 2;
+            for (int n = in.byte() % 32, k = 0; n > 0;--n) {
+                k = sorted ? k + 1 + in.byte() % 4 : in.key();
+                src.push_back(sjtu::pair<const int, int>(k, in.value()));
+            }
+            size_t added = 0;
+            for (size_t i = 0; i < src.size();++i) added += r.insert(ref::value_type(src[i].first, src[i].second)).second;
+            FUZZ_CHECK(m.insert_sorted(src.begin(), src.end()) == added);
+            break;
+        }
+        case 9: {
+            //merge之后相同的键保留本身的值
+            mp o;
+            ref ro;
+            for (int n = in.byte() % 16; n > 0;--n) {
+                int k = in.key(), v = in.value();
+                o[k] = v;
+                ro[k] = v;
+            }
+            r.insert(ro.begin(), ro.end());
+            m.merge(std::move(o));
+            FUZZ_CHECK(o.empty());
+            break;
+        }
+        case 10: {
+            mp c(m);
+            same(c, r);
+            mp d;
+            d[in.key()] = 0;
+            d = c;
+            mp e(std::move(c));
+            FUZZ_CHECK(c.empty());
+            same(e, r);
+            m = std::move(d);
+            break;
+        }
+        case 11: {
+            mp o;
+            o[in.key()] = in.value();
+            m.swap(o);
+            swap(m, o);
+            break;
+        }
+        case 12:
+            if (in.byte() % 8 == 0) {
+                m.clear();
+                r.clear();
+            }
+            break;
+        case 13: {
+            //通过迭代器改值
+            if (r.empty()) break;
+            size_t i = in.position(r.size() - 1);
+            int v = in.value();
+            (*nth(m, i)).second = v;
+            std::next(r.begin(), i)->second = v;
+            break;
+        }
+        }
+        same(m, r);
+    }
+    return 0;
+}
@@ -0,0 +1,100 @@
+/*
+ * differential fuzz target: sjtu::priority_queue against std::priority_queue.
+ */
+#include <queue>
+#include <utility>
+#include <vector>
+#include "fuzz_input.hpp"
+#include "../priority_queue.hpp"
+
+namespace {
+
+typedef sjtu::priority_queue<int> pq;
+typedef std::priority_queue<int> ref;
+
+//弹空两个副本比较全部元素，原队列不动
+void same(const pq &q, const ref &r) {
+    FUZZ_CHECK(q.size() == r.size());
+    FUZZ_CHECK(q.empty() == r.empty());
+    pq a(q);
+    ref b(r);
+    while (!b.empty()) {
+        FUZZ_CHECK(a.top() == b.top());
+        a.pop();
+        b.pop();
+    }
+    FUZZ_CHECK(a.empty());
+}
+
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    sjtu_fuzz::input in(data, size);
+    pq q;
+    ref r;
+    while (!in.empty()) {
+        switch (in.byte() % 7) {
+        case 0: case 1: {
+            //键值范围小，相等元素的合并路径经常走到
+            int x = in.key();
+            q.push(x);
+            r.push(x);
+            break;
+        }
+        case 2:
+            if (r.empty()) {
+                FUZZ_THROWS(q.pop(), sjtu::container_is_empty);
+                FUZZ_THROWS(q.top(), sjtu::container_is_empty);
+            }
+            else {
+                FUZZ_CHECK(q.top() == r.top());
+                q.pop();
+                r.pop();
+            }
+            break;
+        case 3: {
+            pq o;
+            for (int n = in.byte() % 16; n > 0;--n) {
+                int x = in.key();
+                o.push(x);
+                r.push(x);
+            }
+            q.merge(o);
+            FUZZ_CHECK(o.empty() && o.size() == 0);
+            o.push(1);
+            FUZZ_CHECK(o.top() == 1);
+            break;
+        }
+        case 4: {
+            pq c(q);
+            pq d;
+            d.push(in.key());
+            d = c;
+            d = d;
+            pq e(std::move(c));
+            FUZZ_CHECK(c.empty());
+            same(e, r);
+            q = std::move(d);
+            break;
+        }
+        case 5: {
+            pq o;
+            o.push(in.key());
+            q.swap(o);
+            swap(q, o);
+            break;
+        }
+        case 6:
+            if (in.byte() % 8 == 0) {
+                q = pq();
+                r = ref();
+            }
+            break;
+        }
+        if (!r.empty()) FUZZ_CHECK(q.top() == r.top());
+        FUZZ_CHECK(q.size() == r.size());
+        if (in.byte() % 16 == 0) same(q, r);
+    }
+    same(q, r);
+    return 0;
+}
@@ -0,0 +1,160 @@
+/*
+ * differential fuzz target: sjtu::vector against std::vector.
+ */
+#include <vector>
+#include <utility>
+#include "fuzz_input.hpp"
+#include "../vector.hpp"
+
+namespace {
+
+typedef sjtu::vector<int> vec;
+
+//内容、大小以及begin()到end()的距离都要和参照一致
+void same(const vec &v, const std::vector<int> &r) {
+    FUZZ_CHECK(v.size() == r.size());
+    FUZZ_CHECK(v.empty() == r.empty());
+    FUZZ_CHECK(size_t(v.cend() - v.cbegin()) == r.size());
+    size_t i = 0;
+    for (vec::const_iterator it = v.cbegin(); it != v.cend();++it, ++i) FUZZ_CHECK(*it == r[i]);
+    FUZZ_CHECK(i == r.size());
+    for (i = 0; i < r.size();++i) FUZZ_CHECK(v[i] == r[i]);
+    if (!r.empty()) {
+        FUZZ_CHECK(v.front() == r.front());
+        FUZZ_CHECK(v.back() == r.back());
+    }
+}
+
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    sjtu_fuzz::input in(data, size);
+    vec v;
+    std::vector<int> r;
+    while (!in.empty()) {
+        switch (in.byte() % 14) {
+        case 0: {
+            int x = in.value();
+            v.push_back(x);
+            r.push_back(x);
+            break;
+        }
+        case 1:
+            if (r.empty()) FUZZ_THROWS(v.pop_back(), sjtu::container_is_empty);
+            else {
+                v.pop_back();
+                r.pop_back();
+            }
+            break;
+        case 2: {
+            //下标可以越界一格以外，这时要抛异常
+            size_t i = in.position(r.size() + 1);
+            int x = in.value();
+            if (i > r.size()) FUZZ_THROWS(v.insert(i, x), sjtu::index_out_of_bound);
+            else {
+                FUZZ_CHECK(*v.insert(i, x) == x);
+                r.insert(r.begin() + i, x);
+            }
+            break;
+        }
+        case 3: {
+            size_t i = in.position(r.size());
+            int x = in.value();
+            vec::iterator it = v.insert(v.begin() + i, x);
+            r.insert(r.begin() + i, x);
+            FUZZ_CHECK(size_t(it - v.begin()) == i);
+            break;
+        }
+        case 4: {
+            size_t i = in.position(r.size());
+            if (i == r.size()) FUZZ_THROWS(v.erase(i), sjtu::index_out_of_bound);
+            else {
+                vec::iterator it = v.erase(v.begin() + i);
+                r.erase(r.begin() + i);
+                FUZZ_CHECK(it == v.begin() + i);
+                FUZZ_CHECK((it == v.end()) == (i == r.size()));
+            }
+            break;
+        }
+        case 5: {
+            size_t i = in.position(r.size()), j = in.position(r.size());
+            if (i > j) std::swap(i, j);
+            vec::iterator it = v.erase(v.begin() + i, v.begin() + j);
+            r.erase(r.begin() + i, r.begin() + j);
+            FUZZ_CHECK(size_t(it - v.begin()) == i);
+            break;
+        }
+        case 6: {
+            size_t i = in.position(r.size());
+            if (i == r.size()) {
+                FUZZ_THROWS(v.at(i), sjtu::index_out_of_bound);
+                FUZZ_THROWS(v[i], sjtu::index_out_of_bound);
+            }
+            else {
+                int x = in.value();
+                FUZZ_CHECK(v.at(i) == r[i]);
+                v[i] = x;
+                r[i] = x;
+            }
+            break;
+        }
+        case 7:
+            if (r.empty()) {
+                FUZZ_THROWS(v.front(), sjtu::container_is_empty);
+                FUZZ_THROWS(v.back(), sjtu::container_is_empty);
+            }
+            else FUZZ_CHECK(v.front() == r.front() && v.back() == r.back());
+            break;
+        case 8: {
+            size_t n = in.byte();
+            int x = in.value();
+            v.resize(n, x);
+            r.resize(n, x);
+            break;
+        }
+        case 9: {
+            size_t i = in.position(r.size()), n = in.byte() % 16;
+            int x = in.value();
+            v.insert(v.begin() + i, n, x);
+            r.insert(r.begin() + i, n, x);
+            break;
+        }
+        case 10: {
+            //插入的值就是容器里的元素
+            if (r.empty()) break;
+            size_t i = in.position(r.size() - 1), j = in.position(r.size());
+            v.insert(j, v[i]);
+            r.insert(r.begin() + j, int(r[i]));
+            break;
+        }
+        case 11: {
+            vec c(v);
+            same(c, r);
+            vec d;
+            d = c;
+            vec e(std::move(c));
+            FUZZ_CHECK(c.empty());
+            same(e, r);
+            v = std::move(d);
+            break;
+        }
+        case 12: {
+            vec o;
+            o.push_back(in.value());
+            v.swap(o);
+            swap(v, o);
+            break;
+        }
+        case 13:
+            if (in.byte() % 8 == 0) {
+                v.clear();
+                r.clear();
+            }
+            else if (in.byte() % 2) v.shrink_to_fit();
+            else v.reserve(in.byte());
+            break;
+        }
+        same(v, r);
+    }
+    return 0;
+}
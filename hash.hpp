@@ -0,0 +1,170 @@
+#ifndef SJTU_HASH_HPP
+#define SJTU_HASH_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace sjtu {
+
+namespace hash_detail {
+    inline uint64_t rotl(uint64_t x, int b) {
+        return (x << b) | (x >> (64 - b));
+    }
+    inline void sip_round(uint64_t &v0, uint64_t &v1, uint64_t &v2, uint64_t &v3) {
+        v0 += v1; v1 = rotl(v1, 13); v1 ^= v0; v0 = rotl(v0, 32);
+        v2 += v3; v3 = rotl(v3, 16); v3 ^= v2;
+        v0 += v3; v3 = rotl(v3, 21); v3 ^= v0;
+        v2 += v1; v1 = rotl(v1, 17); v1 ^= v2; v2 = rotl(v2, 32);
+    }
+    /**
+     * whether equal keys always have equal bytes and the bytes hold nothing but the value,
+     *   so that a key can be hashed as its object representation.
+     */
+    template<class Key>
+    class has_unique_bytes : public std::integral_constant<bool,
+        std::is_integral<Key>::value || std::is_enum<Key>::value || std::is_pointer<Key>::value> {};
+}
+
+/**
+ * SipHash-2-4 of len bytes at data under the 128-bit key (k0, k1).
+ * words are read in native byte order, so on big-endian machines the values differ from
+ *   the reference vectors (the quality of the hash does not).
+ */
+inline uint64_t siphash(const void *data, size_t len, uint64_t k0, uint64_t k1) {
+    const unsigned char *in = static_cast<const unsigned char *>(data);
+    uint64_t v0 = 0x736f6d6570736575ULL ^ k0, v1 = 0x646f72616e646f6dULL ^ k1;
+    uint64_t v2 = 0x6c7967656e657261ULL ^ k0, v3 = 0x7465646279746573ULL ^ k1;
+    size_t end = len - len % 8;
+    for (size_t i = 0; i < end; i += 8) {
+        uint64_t m;
+        memcpy(&m, in + i, 8);
+        v3 ^= m;
+        hash_detail::sip_round(v0, v1, v2, v3);
+        hash_detail::sip_round(v0, v1, v2, v3);
+        v0 ^= m;
+    }
+    //最后不足8字节的部分和长度拼成一个字
+    uint64_t b = uint64_t(len) << 56;
+    for (size_t i = 0; i < len % 8;++i) b |= uint64_t(in[end + i]) << (8 * i);
+    v3 ^= b;
+    hash_detail::sip_round(v0, v1, v2, v3);
+    hash_detail::sip_round(v0, v1, v2, v3);
+    v0 ^= b;
+    v2 ^= 0xff;
+    for (int i = 0; i < 4;++i) hash_detail::sip_round(v0, v1, v2, v3);
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+namespace hash_detail {
+    //进程内唯一的128位密钥，只在第一次用到时读一次random_device
+    class seed_source {
+    public:
+        uint64_t k0, k1;
+        std::atomic<uint64_t> counter;
+        seed_source() : counter(0) {
+            std::random_device rd;
+            k0 = uint64_t(rd()) << 32 | rd();
+            k1 = uint64_t(rd()) << 32 | rd();
+        }
+    };
+    /**
+     * a fresh 64-bit seed on every call: SipHash of a counter under the process key.
+     * SipHash is a PRF, so seeds that leak (e.g. through a saved frozen hashmap) reveal
+     *   neither the process key nor any other seed.
+     */
+    inline uint64_t random_seed() {
+        static seed_source src;
+        uint64_t c = src.counter.fetch_add(1, std::memory_order_relaxed);
+        return siphash(&c, sizeof(c), src.k0, src.k1);
+    }
+}
+
+/**
+ * a keyed hash with a random key per object, for containers whose keys come from
+ *   untrusted input: without the key nobody can precompute a set of keys that collide.
+ * integers, enums, pointers and strings are hashed from their bytes. any other Key is first
+ *   hashed with std::hash and the result is run through SipHash; keys that collide under
+ *   std::hash then collide under every key, which no reseeding can repair.
+ * reseed() draws a new key, every value returned before becomes meaningless.
+ */
+template<class Key>
+class seeded_hash {
+private:
+    uint64_t k0, k1;
+public:
+    seeded_hash() {
+        reseed();
+    }
+    seeded_hash(uint64_t k0, uint64_t k1) : k0(k0), k1(k1) {}
+    void reseed() {
+        k0 = hash_detail::random_seed();
+        k1 = hash_detail::random_seed();
+    }
+    void get_key(uint64_t &key0, uint64_t &key1) const {
+        key0 = k0;
+        key1 = k1;
+    }
+    size_t operator()(const Key &key) const {
+        return hash(key, hash_detail::has_unique_bytes<Key>());
+    }
+private:
+    size_t hash(const Key &key, std::true_type) const {
+        return size_t(siphash(&key, sizeof(Key), k0, k1));
+    }
+    size_t hash(const Key &key, std::false_type) const {
+        uint64_t h = std::hash<Key>()(key);
+        return size_t(siphash(&h, sizeof(h), k0, k1));
+    }
+};
+
+template<>
+class seeded_hash<std::string> {
+private:
+    uint64_t k0, k1;
+public:
+    seeded_hash() {
+        reseed();
+    }
+    seeded_hash(uint64_t k0, uint64_t k1) : k0(k0), k1(k1) {}
+    void reseed() {
+        k0 = hash_detail::random_seed();
+        k1 = hash_detail::random_seed();
+    }
+    void get_key(uint64_t &key0, uint64_t &key1) const {
+        key0 = k0;
+        key1 = k1;
+    }
+    size_t operator()(const std::string &key) const {
+        return size_t(siphash(key.data(), key.size(), k0, k1));
+    }
+};
+
+/**
+ * whether Hash has a reseed() member, i.e. whether a container can recover from
+ *   collisions by drawing a new key and rehashing.
+ */
+template<class Hash, class = void>
+class is_reseedable : public std::false_type {};
+template<class Hash>
+class is_reseedable<Hash, decltype(std::declval<Hash &>().reseed(), void())> : public std::true_type {};
+
+/**
+ * whether Hash is keyed like seeded_hash: get_key(k0, k1) reads its key and Hash(k0, k1)
+ *   makes a Hash with the same key, so hash values can be reproduced in another process.
+ */
+template<class Hash, class = void>
+class is_keyed_hash : public std::false_type {};
+template<class Hash>
+class is_keyed_hash<Hash, decltype(std::declval<const Hash &>().get_key(std::declval<uint64_t &>(),
+    std::declval<uint64_t &>()), void())> : public std::true_type {};
+
+}
+
+#endif
@@ -3,16 +3,25 @@
 
 #include <cstddef>
 #include <functional>
+#include <utility>
 #include "utility.hpp"
 #include "algorithm.hpp"
 #include "exceptions.hpp"
+#include "hash.hpp"
+#include "stats.hpp"
 #include "list.hpp"
+#include "vector.hpp"
 
 namespace sjtu {
 	/**
 	 *  Maintains key-value pairs just like MAP
 	 *  Dynamically sized hash table who handles collision with linked lists
 	 *  Iterators arrange in order of insertion (maintained by base class LIST)
+	 *  Every map holds its own Hash object. If Hash has reseed() (e.g. seeded_hash), a chain
+	 *    growing beyond MAX_CHAIN makes the map draw a new seed and rehash all elements,
+	 *    see hardened_hashmap below. A map reseeds at most once until its size doubles, so
+	 *    keys whose hash values are equal under every seed make long chains but never a
+	 *    rehash on every insertion.
 	 */
 
 template <
@@ -26,14 +35,18 @@ public:
     using value_type = pair<const Key, Value>;
     using list<value_type>::head;
     using list<value_type>::tail;
-    using list<value_type>::nil;
     static constexpr size_t CAPACITY = 1 << 4;
     static constexpr float LOAD_FACTOR = 0.75f;
     static constexpr size_t THRESHOLD = CAPACITY * LOAD_FACTOR;
+    //桶数的上限，reserve翻倍到这里为止，桶数组的字节数不会溢出
+    static constexpr size_t MAX_CAPACITY = size_t(1) << (sizeof(size_t) * 8 - 5);
+    //可重新播种的Hash下链长超过它就换种子重新散列
+    static constexpr size_t MAX_CHAIN = 16;
     size_t cap, thre;
-    static size_t get_hash(const Key&key) {
-        static Hash hash;
-        return hash(key);
+    //元素个数到达它之前不再换种子
+    size_t reseed_at;
+    size_t get_hash(const Key&key) const {
+        return hasher(key);
     }
     size_t index(size_t h, size_t len) const {
         return h & (len - 1);
@@ -49,14 +62,14 @@ private:
          */
         Node *nx;
         size_t hv;
+        //哈希值要用map自己的hasher算，由构造结点的地方填好
         Node():nx(nullptr),hv(-1){}
-        Node(const Key &k,const Value &v):nx(nullptr){
-            this->val=new value_type(k,v);
-            hv=get_hash(k);
+        Node(const value_type &kv,size_t h):nx(nullptr),hv(h){
+            this->data=new value_type(kv);
         }
-        Node(const value_type &kv):nx(nullptr){
-            this->val=new value_type(kv);
-            hv=get_hash(kv->first);
+        //直接接管已经构造好的kv，不再拷贝一次
+        Node(value_type *kv,size_t h):nx(nullptr),hv(h){
+            this->data=kv;
         }
     };
 
@@ -80,26 +93,19 @@ private:
             Equal equal;
             Node *p=head->nx;
             while (p) {
-                if (equal(p->val->first,o)) return p;
+                if (equal(p->data->first,o)) return p;
                 p=p->nx;
             }
             return nullptr;
         }
         /**
-         * TODO insert key-value pair(k, v) into this BucketList
-         * return this new Node
+         * link an already constructed Node p (with hv set) into this BucketList
          */
-        Node * insert(const Key &k, const Value &v) {
-            Node *p=new Node(k,v);
+        Node * insert(Node *p) {
             p->nx=head->nx;
             head->nx=p;
-            size_t hash_val=get_hash(k);
-            p->hv=hash_val;
             return p;
         }
-        Node * insert(const value_type &kv) {
-            return insert(kv.first, kv.second);
-        }
         /**
          * TODO remove the Node with key k from this BucketList (no need to delete)
          * return the removed Node
@@ -108,7 +114,7 @@ private:
             Equal equal;
             Node *p=head;
             Node *q=head->nx;
-            while (q && !equal(q->val->first,k)) q=q->nx,p=p->nx;
+            while (q && !equal(q->data->first,k)) q=q->nx,p=p->nx;
             if (!q) return nullptr;
             p->nx=q->nx;
             q->nx=nullptr;
@@ -120,13 +126,29 @@ private:
      * add data members as needed and necessary private function such as resize()
      */
     BucketList *hashtable;
+    Hash hasher;
+#ifdef SJTU_STATS
+    hashmap_stats counters;
+    //哈希表是一个数组加上每个桶的头结点
+    void count_table(size_t len) {
+        counters.allocations+=len+1;
+        counters.bytes_allocated+=len*(sizeof(BucketList)+sizeof(Node));
+    }
+    //每个元素是结点和value_type两块
+    void count_node() {
+        counters.allocations+=2;
+        counters.bytes_allocated+=sizeof(Node)+sizeof(value_type);
+    }
+#endif
     void resize(size_t newCap) {
         cap = newCap;
         thre = cap * LOAD_FACTOR;
         if (hashtable) delete [] hashtable;
         hashtable = new BucketList[cap];
-        for (typename list<value_type>::node* p = head->nxt; p != this->nil; p = p->nxt) {
-            Node* q = dynamic_cast<Node*>(p);
+        SJTU_STAT(++counters.resizes;)
+        SJTU_STAT(count_table(cap);)
+        for (typename list<value_type>::node* p = head->next; p != tail; p = p->next) {
+            Node* q = static_cast<Node*>(p);
             Node*& n = hashtable[index(q->hv,cap)].head;
             //resize和copy在这里不同的原因是resize插入的是list上的原节点，而copy是创建一个新节点插入，调用insert会创建新节点
             q->nx = n->nx;
@@ -137,12 +159,83 @@ private:
     void copy(const linked_hashmap& other) {
         cap = other.cap;
         thre = other.thre;
-        this->num = 0;
+        this->cur_len = 0;
+        hasher = other.hasher;
+        reseed_at = other.reseed_at;
+        //other还没有分配过哈希表时不能分配长度为0的表
+        hashtable = nullptr;
+        if (!other.hashtable) return;
         hashtable = new BucketList[cap];
-        for (typename list<value_type>::node* p = other.head->nxt; p != other.nil; p = p->nxt) {
-            Node* n = hashtable[index(p->val->first)].insert(*p->val);
-            list<value_type>::insert(this->nil, n);
+        SJTU_STAT(count_table(cap);)
+        //hasher相同，哈希值可以直接沿用
+        for (typename list<value_type>::node* p = other.head->next; p != other.tail; p = p->next) {
+            size_t h = static_cast<Node*>(p)->hv;
+            Node* n = hashtable[index(h,cap)].insert(new Node(*p->data,h));
+            SJTU_STAT(count_node();)
+            list<value_type>::insert(tail, n);
+        }
+    }
+    /**
+     * link a new Node whose key does not exist yet into the hashtable and the list
+     */
+    Node *insert_node(Node *n) {
+        if (!hashtable) resize(CAPACITY);
+        if (this->cur_len>=thre) resize(cap<<1);
+        SJTU_STAT(count_node();)
+        hashtable[index(n->hv,cap)].insert(n);
+        list<value_type>::insert(tail,n);
+#ifndef NDEBUG
+        check_chain(index(n->hv,cap));
+#endif
+        if (is_reseedable<Hash>::value && this->cur_len>=reseed_at && bucket_size(index(n->hv,cap))>MAX_CHAIN)
+            rehash_with_new_seed(is_reseedable<Hash>());
+        return n;
+    }
+    //链过长说明种子被猜中了或者运气太差，换一个种子把所有元素重新散列
+    void rehash_with_new_seed(std::true_type) {
+        hasher.reseed();
+        for (typename list<value_type>::node* p = head->next; p != tail; p = p->next) {
+            Node* q = static_cast<Node*>(p);
+            q->hv = get_hash(q->data->first);
+        }
+        resize(cap);
+        reseed_at=this->cur_len*2;
+        SJTU_STAT(++counters.reseeds;)
+    }
+    void rehash_with_new_seed(std::false_type) {}
+    /**
+     * delete every element; the nodes are Nodes, so they must not be deleted through
+     *   list::erase, which deletes a list::node
+     */
+    void release() {
+        typename list<value_type>::node *p=head->next;
+        while (p!=tail) {
+            typename list<value_type>::node *q=p->next;
+            delete static_cast<Node*>(p);
+            p=q;
         }
+        head->next=tail;
+        tail->prev=head;
+        this->cur_len=0;
+    }
+public:
+    typedef std::function<void(const linked_hashmap &,size_t,size_t)> chain_hook;
+private:
+    //同一类型的map共用一个告警回调
+    class chain_warning {
+    public:
+        size_t limit;
+        chain_hook hook;
+    };
+    static chain_warning &warning() {
+        static chain_warning w={8,chain_hook()};
+        return w;
+    }
+    void check_chain(size_t i) const {
+        const chain_warning &w=warning();
+        if (!w.hook) return;
+        size_t len=bucket_size(i);
+        if (len>w.limit) w.hook(*this,i,len);
     }
 public:
     /**
@@ -154,25 +247,63 @@ public:
     /**
     * TODO two constructors
     */
-    linked_hashmap():cap(0),thre(0),hashtable(nullptr) {}
+    linked_hashmap():cap(0),thre(0),reseed_at(0),hashtable(nullptr) {}
     linked_hashmap(const linked_hashmap &other) {
         this->copy(other);
     }
+    /**
+     * move constructor, takes over the nodes and the hashtable of other without allocating.
+     * other is left as a default-constructed map.
+     */
+    linked_hashmap(linked_hashmap &&other) noexcept
+        :list<value_type>(std::move(other)),cap(other.cap),thre(other.thre),reseed_at(other.reseed_at),
+         hashtable(other.hashtable),hasher(other.hasher) {
+        other.cap=0;
+        other.reseed_at=0;
+        other.thre=0;
+        other.hashtable=nullptr;
+    }
     /**
 	 * TODO assignment operator
 	 */
     linked_hashmap &operator=(const linked_hashmap &other) {
         if (this==&other) return *this;
-        list<value_type>::clear();
+        release();
         delete []hashtable;
         this->copy(other);
         return *this;
     }
+    /**
+     * move assignment, releases the old contents and takes over those of other.
+     * nothing is allocated: other is left empty with no hashtable.
+     */
+    linked_hashmap &operator=(linked_hashmap &&other) noexcept {
+        if (this==&other) return *this;
+        //不能用list的移动赋值，它调用的虚函数clear()会分配新表
+        release();
+        delete []hashtable;
+        hashtable=nullptr;
+        cap=thre=reseed_at=0;
+        swap(other);
+        return *this;
+    }
+    /**
+     * exchanges the contents with other in O(1), no element is copied.
+     */
+    void swap(linked_hashmap &other) noexcept {
+        list<value_type>::swap(other);
+        std::swap(cap,other.cap);
+        std::swap(thre,other.thre);
+        std::swap(reseed_at,other.reseed_at);
+        std::swap(hashtable,other.hashtable);
+        std::swap(hasher,other.hasher);
+    }
     /**
 	 * TODO Destructors
 	 */
     ~linked_hashmap() {
-        //clear();这里会再次调用list的析构函数所有不用手动clear了
+        //list的析构函数只认识list::node，元素要在这里按Node释放
+        release();
         delete []hashtable;
     }
     /**
@@ -184,13 +315,13 @@ public:
         if (!hashtable) throw index_out_of_bound();
         Node *p=hashtable[index(key)].find(key);
         if (!p) throw index_out_of_bound();
-        return p->val->second;
+        return p->data->second;
     }
     const Value &at(const Key &key) const {
         if (!hashtable) throw index_out_of_bound();
         Node *p=hashtable[index(key)].find(key);
         if (!p) throw index_out_of_bound();
-        return p->val->second;
+        return p->data->second;
     }
     /**
 	 * TODO access specified element
@@ -198,14 +329,10 @@ public:
 	 *   performing an insertion if such key does not already exist.
 	 */
     Value &operator[](const Key &key) {
-        if (!hashtable) return insert({key, Value()}).first->second;
+        if (!hashtable) resize(CAPACITY);
         Node *p=hashtable[index(key)].find(key);
-        if (!p) {
-            if (this->num>=thre) resize(cap<<1);
-            p=hashtable[index(key)].insert(key,Value());
-            list<value_type>::insert(this->nil,p);
-        }
-        return p->val->second;
+        if (!p) p=insert_node(new Node(new value_type(key,Value()),get_hash(key)));
+        return p->data->second;
     }
     /**
 	 * behave like at() throw index_out_of_bound if such key does not exist.
@@ -218,11 +345,12 @@ public:
 	 */
     void clear() override{
         if (!hashtable) return;
-        list<value_type>::clear();
+        release();
         delete [] hashtable;
         cap=CAPACITY;
         thre=THRESHOLD;
         hashtable = new BucketList[cap];
+        SJTU_STAT(count_table(cap);)
     }
     /**
 	 * TODO insert an element.
@@ -235,22 +363,93 @@ public:
         Node *n=hashtable[index(value.first)].find(value.first);
         if (n) return {iterator(n,this),false};
         else {
-            if (this->num>=thre) resize(cap<<1);
-            n=hashtable[index(value.first)].insert(value);
-            list<value_type>::insert(this->nil,n);
+            n=insert_node(new Node(value,get_hash(value.first)));
             return {iterator(n,this),true};
         }
     }
+    pair<iterator, bool> insert(value_type &&value) {
+        return emplace(std::move(value));
+    }
+    /**
+     * construct a value_type from args and insert it if its key does not exist yet.
+     * the element is constructed exactly once and never copied afterwards;
+     *   it is destroyed again if the key already exists.
+     * return the same as insert.
+     */
+    template<class... Args>
+    pair<iterator, bool> emplace(Args&&... args) {
+        if (!hashtable) resize(CAPACITY);
+        value_type *kv=new value_type(std::forward<Args>(args)...);
+        Node *n=hashtable[index(kv->first)].find(kv->first);
+        if (n) {
+            delete kv;
+            return {iterator(n,this),false};
+        }
+        n=insert_node(new Node(kv,get_hash(kv->first)));
+        return {iterator(n,this),true};
+    }
+    /**
+     * if key does not exist, insert an element whose mapped value is constructed from args;
+     *   otherwise do nothing, args are not touched.
+     * return the same as insert.
+     */
+    template<class... Args>
+    pair<iterator, bool> try_emplace(const Key &key,Args&&... args) {
+        if (!hashtable) resize(CAPACITY);
+        Node *n=hashtable[index(key)].find(key);
+        if (n) return {iterator(n,this),false};
+        n=insert_node(new Node(new value_type(key,Value(std::forward<Args>(args)...)),get_hash(key)));
+        return {iterator(n,this),true};
+    }
+    template<class... Args>
+    pair<iterator, bool> try_emplace(Key &&key,Args&&... args) {
+        if (!hashtable) resize(CAPACITY);
+        size_t h=get_hash(key);
+        Node *n=hashtable[index(h,cap)].find(key);
+        if (n) return {iterator(n,this),false};
+        n=insert_node(new Node(new value_type(std::move(key),Value(std::forward<Args>(args)...)),h));
+        return {iterator(n,this),true};
+    }
+    /**
+     * assign obj to the mapped value of key, inserting a new element if key does not exist.
+     * return the same as insert, the second one is true if a new element is inserted.
+     */
+    template<class M>
+    pair<iterator, bool> insert_or_assign(const Key &key,M &&obj) {
+        if (!hashtable) resize(CAPACITY);
+        Node *n=hashtable[index(key)].find(key);
+        if (n) {
+            n->data->second=std::forward<M>(obj);
+            return {iterator(n,this),false};
+        }
+        n=insert_node(new Node(new value_type(key,std::forward<M>(obj)),get_hash(key)));
+        return {iterator(n,this),true};
+    }
+    template<class M>
+    pair<iterator, bool> insert_or_assign(Key &&key,M &&obj) {
+        if (!hashtable) resize(CAPACITY);
+        size_t h=get_hash(key);
+        Node *n=hashtable[index(h,cap)].find(key);
+        if (n) {
+            n->data->second=std::forward<M>(obj);
+            return {iterator(n,this),false};
+        }
+        n=insert_node(new Node(new value_type(std::move(key),std::forward<M>(obj)),h));
+        return {iterator(n,this),true};
+    }
     /**
 	 * TODO erase the element at pos.
 	 * throw if pos pointed to a bad element (pos == this->end() || pos points an element out of this)
      * return anything, it doesn't matter
 	 */
     iterator erase(iterator pos) override{
-        if (!hashtable || pos.invalid(this)) throw invalid_iterator();
-        hashtable[index(pos->first)].erase(pos->first);
-        iterator ite=list<value_type>::erase(pos);
-        if (this->num<=cap>>2) resize(cap>>1);
+        if (!hashtable || pos.lis!=this || !pos.pnode || pos.pnode==head || pos.pnode==tail)
+            throw invalid_iterator();
+        Node *n=static_cast<Node*>(pos.pnode);
+        iterator ite(n->next,this);
+        hashtable[index(n->hv,cap)].erase(n->data->first);
+        delete static_cast<Node*>(list<value_type>::erase(pos.pnode));
+        if (cap>CAPACITY && this->cur_len<=cap>>2) resize(cap>>1);
         return ite;
     }
     /**
@@ -277,13 +476,133 @@ public:
         else return iterator(n,this);
     }
     const_iterator find(const Key &key) const {
-        if (!hashtable) this->cend();
+        if (!hashtable) return this->cend();
         Node *n=hashtable[index(key)].find(key);
         if (!n) return this->cend();
         else return const_iterator(n,this);
     }
+    /**
+     * returns a copy of the Hash object of this map.
+     */
+    Hash hash_function() const {
+        return hasher;
+    }
+    /**
+     * returns the number of buckets of the hashtable, 0 before the first insertion.
+     */
+    size_t bucket_count() const {
+        return hashtable ? cap : 0;
+    }
+    /**
+     * enlarge the hashtable in advance so that n elements fit without rehashing.
+     * the hashtable has at most MAX_CAPACITY buckets, a larger n is reserved only up to that.
+     */
+    void reserve(size_t n) {
+        size_t newCap=CAPACITY;
+        while (newCap<MAX_CAPACITY&&newCap*LOAD_FACTOR<=n) newCap<<=1;
+        if (newCap>cap) resize(newCap);
+    }
+    /**
+     * returns the number of elements in bucket i.
+     * throw index_out_of_bound if i >= bucket_count()
+     */
+    size_t bucket_size(size_t i) const {
+        if (i>=bucket_count()) throw index_out_of_bound();
+        size_t len=0;
+        for (const Node *p=hashtable[i].head->nx;p;p=p->nx) ++len;
+        return len;
+    }
+    /**
+     * returns the average number of elements per bucket, 0 before the first insertion.
+     */
+    float load_factor() const {
+        return hashtable ? float(this->cur_len)/cap : 0.0f;
+    }
+    /**
+     * returns h with h[i] the number of buckets holding exactly i elements,
+     *   h.size() is one more than the longest chain.
+     */
+    vector<size_t> occupancy_histogram() const {
+        vector<size_t> h;
+        for (size_t i=0;i<bucket_count();++i) {
+            size_t len=bucket_size(i);
+            while (h.size()<=len) h.push_back(0);
+            ++h[len];
+        }
+        return h;
+    }
+    /**
+     * returns h with h[i] the number of elements found after comparing i keys,
+     *   i.e. the cost of every successful find(); h[0] is always 0.
+     */
+    vector<size_t> probe_histogram() const {
+        vector<size_t> h;
+        for (size_t i=0;i<bucket_count();++i) {
+            size_t k=0;
+            for (const Node *p=hashtable[i].head->nx;p;p=p->nx) {
+                ++k;
+                while (h.size()<=k) h.push_back(0);
+                ++h[k];
+            }
+        }
+        return h;
+    }
+    /**
+     * in builds without NDEBUG, hook(map, bucket, length) is called whenever an insertion
+     *   makes a chain longer than limit, a sign of a poor Hash or of adversarial keys.
+     * the hook is shared by all maps of this type; pass an empty hook to remove it.
+     */
+    static void set_chain_warning(size_t limit,chain_hook hook) {
+        warning().limit=limit;
+        warning().hook=std::move(hook);
+    }
+    /**
+     * returns the counters of this hashmap when compiled with SJTU_STATS, zeros otherwise.
+     * the chain length histogram is computed on the spot in O(bucket_count()).
+     */
+    hashmap_stats stats() const {
+        hashmap_stats res;
+        SJTU_STAT(res=counters;)
+#ifdef SJTU_STATS
+        for (size_t i=0;i<bucket_count();++i) {
+            size_t len=bucket_size(i);
+            ++res.chains[len<hashmap_stats::CHAIN_HISTOGRAM ? len : hashmap_stats::CHAIN_HISTOGRAM-1];
+            if (len>res.longest_chain) res.longest_chain=len;
+        }
+#endif
+        return res;
+    }
+    /**
+     * call f on every element in the buckets [lo, hi), bucket by bucket.
+     * disjoint bucket ranges may be visited from different threads at the same time,
+     *   as long as nothing is inserted or erased meanwhile.
+     */
+    template<class F>
+    void for_each_bucket(size_t lo,size_t hi,F &&f) {
+        for (size_t i=lo;i<hi;++i)
+            for (Node *p=hashtable[i].head->nx;p;p=p->nx) f(*p->data);
+    }
+    template<class F>
+    void for_each_bucket(size_t lo,size_t hi,F &&f) const {
+        for (size_t i=lo;i<hi;++i)
+            for (const Node *p=hashtable[i].head->nx;p;p=p->nx) f(static_cast<const value_type &>(*p->data));
+    }
 };
 
+/**
+ * a linked_hashmap for keys from untrusted input: every map hashes with its own random
+ *   SipHash key, and reseeds itself if a chain still grows longer than MAX_CHAIN.
+ * integral, enum, pointer and string keys are keyed on their bytes; other keys are only as
+ *   good as their std::hash, see seeded_hash.
+ */
+template<class Key,class Value,class Equal=std::equal_to<Key> >
+using hardened_hashmap=linked_hashmap<Key,Value,seeded_hash<Key>,Equal>;
+
+template<class Key,class Value,class Hash,class Equal>
+void swap(linked_hashmap<Key,Value,Hash,Equal> &a,linked_hashmap<Key,Value,Hash,Equal> &b) noexcept {
+    a.swap(b);
+}
+
 }
 
 #endif
\ No newline at end of file
@@ -3,9 +3,11 @@
 
 #include "exceptions.hpp"
 #include "algorithm.hpp"
+#include "sequential_sort.hpp"
 
 #include <climits>
 #include <cstddef>
+#include <utility>
 
 namespace sjtu {
 /**
@@ -48,6 +50,24 @@ protected:
      */
     node *head, *tail;
     size_t cur_len;
+    //头尾两个哨兵放在对象里，移动和交换都不用分配；reverse会交换head和tail
+    node ends[2];
+    void init_ends() {
+        head = ends;
+        tail = ends + 1;
+        head->next = tail;
+        tail->prev = head;
+    }
+    //把哨兵fh、ft之间的结点整段挪到空的哨兵th、tt之间
+    static void move_nodes(node *fh, node *ft, node *th, node *tt) {
+        if (fh->next == ft) return;
+        th->next = fh->next;
+        th->next->prev = th;
+        tt->prev = ft->prev;
+        tt->prev->next = tt;
+        fh->next = ft;
+        ft->prev = fh;
+    }
     /**
      * insert node cur before node pos
      * return the inserted node cur
@@ -217,7 +237,7 @@ public:
         const T * operator ->() const {
             if (pnode==nullptr || !pnode->prev || !pnode->next)
                 throw invalid_iterator();
-            return *(pnode->data);
+            return pnode->data;
         }
         bool operator==(const iterator &rhs) const {
             if ((lis==rhs.lis) && (pnode==rhs.pnode)) return 1;
@@ -239,15 +259,11 @@ public:
      * Atleast two: default constructor, copy constructor
      */
     list() {
-        head = new node();
-        tail = new node();
-        head->next = tail;
-        tail->prev = head;
+        init_ends();
         cur_len = 0;
     }
     list(const list &other) {
-        head = new node();
-        tail = new node();
+        init_ends();
         node *p = other.head;
         node *q = head;
         cur_len = other.cur_len;
@@ -260,13 +276,19 @@ public:
         q->next = tail;
         tail->prev = q;
     }
+    /**
+     * move constructor, takes over the nodes of other in O(1) without allocating.
+     */
+    list(list &&other) noexcept : list() {
+        move_nodes(other.head, other.tail, head, tail);
+        cur_len = other.cur_len;
+        other.cur_len = 0;
+    }
     /**
      * TODO Destructor
      */
     virtual ~list() {
         clear();
-        delete head;
-        delete tail;
     }
     /**
      * TODO Assignment operator
@@ -275,11 +297,7 @@ public:
         if (this==&other)
             return *this;
         clear();
-        delete head;
-        delete tail;
         cur_len = other.cur_len;
-        head = new node();
-        tail = new node();
         node *p = other.head;
         node *q = head;
         for (size_t i = 1; i <= cur_len;++i){
@@ -292,6 +310,29 @@ public:
         tail->prev = q;
         return *this;
     }
+    /**
+     * move assignment, releases the old contents and takes over the nodes of other.
+     */
+    list &operator=(list &&other) noexcept {
+        if (this==&other)
+            return *this;
+        clear();
+        swap(other);
+        return *this;
+    }
+    /**
+     * exchanges the contents with other in O(1), no element is copied.
+     */
+    void swap(list &other) noexcept {
+        //哨兵不能交换，结点借一对临时哨兵转一手
+        node h, t;
+        h.next = &t;
+        t.prev = &h;
+        move_nodes(head, tail, &h, &t);
+        move_nodes(other.head, other.tail, head, tail);
+        move_nodes(&h, &t, other.head, other.tail);
+        std::swap(cur_len, other.cur_len);
+    }
     /**
      * access the first / last element
      * throw container_is_empty when the container is empty.
@@ -427,7 +468,7 @@ public:
             (*iter).~T();
         }
         iter.pnode = head;
-        sjtu::sort<T>(tmp, tmp + cur_len, cmp);
+        sjtu::intro_sort(tmp, tmp + cur_len, cmp);
         for (size_t i = 0; i < cur_len;++i){
             ++iter;
             new (&(*iter)) T(tmp[i]);
@@ -504,6 +545,11 @@ public:
     }
 };
 
+template<typename T>
+void swap(list<T> &a, list<T> &b) noexcept {
+    a.swap(b);
+}
+
 }
 
 #endif //SJTU_LIST_HPP
\ No newline at end of file
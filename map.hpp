@@ -7,11 +7,73 @@
 // only for std::less<T>
 #include <functional>
 #include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
 #include "utility.hpp"
 #include "exceptions.hpp"
+#include "stats.hpp"
 
 namespace sjtu {
 
+template<class Key,class T,class Compare>
+class frozen_map;
+
+/**
+ * the part of a key that map keeps inline in every node, so that a descent can compare
+ *   against the node it already loaded instead of following data to the key.
+ * compare(o) returns a negative / positive number if the key of this is less / greater
+ *   than that of o, and 0 if they are equal or the cached part cannot tell;
+ *   exact says whether 0 always means equal.
+ * by default nothing is cached and compare() is always 0.
+ */
+template<class Key,class Compare,class Enable=void>
+class map_key_cache {
+public:
+    static const bool exact=false;
+    map_key_cache() {}
+    explicit map_key_cache(const Key &) {}
+    int compare(const map_key_cache &) const {return 0;}
+};
+
+//小的平凡可复制键直接在结点里存一份，比较完全不用访问data
+template<class Key,class Compare>
+class map_key_cache<Key,Compare,typename std::enable_if<
+    std::is_trivially_copyable<Key>::value && sizeof(Key)<=2*sizeof(void*)>::type> {
+private:
+    //哨兵结点没有键，Key也不一定能默认构造，所以用原始存储
+    alignas(Key) unsigned char buf[sizeof(Key)];
+    const Key &key() const {return *reinterpret_cast<const Key *>(buf);}
+public:
+    static const bool exact=true;
+    map_key_cache() {}
+    explicit map_key_cache(const Key &k) {new (buf) Key(k);}
+    int compare(const map_key_cache &o) const {
+        if (Compare()(key(),o.key())) return -1;
+        if (Compare()(o.key(),key())) return 1;
+        return 0;
+    }
+};
+
+//按字典序比较的字符串存前8个字节，前缀不同时就能定下大小
+template<>
+class map_key_cache<std::string,std::less<std::string> > {
+private:
+    uint64_t prefix;
+public:
+    static const bool exact=false;
+    map_key_cache():prefix(0) {}
+    explicit map_key_cache(const std::string &k):prefix(0) {
+        size_t n=k.size()<8?k.size():8;
+        for (size_t i=0;i<n;++i) prefix|=uint64_t((unsigned char)k[i])<<(56-8*i);
+    }
+    int compare(const map_key_cache &o) const {
+        return prefix<o.prefix?-1:(prefix>o.prefix?1:0);
+    }
+};
+
 template<
     class Key,
     class T,
@@ -25,35 +87,81 @@ private:
         Compare cmp;
         return (!cmp(x,y) && !cmp(y,x));
     }
+    typedef map_key_cache<Key,Compare> key_cache;
+    //查找时要用的字段放在最前面，一层只碰一条缓存行；value_type单独分配
     class Node{
     public:
-        value_type *data;
-        Node *fa,*ls,*rs;
+        key_cache kc;
+        Node *ls,*rs;
         int h;
+        size_t sz;//子树大小，用于rank/select
+        Node *fa;
+        Node *prv,*nxt;//中序的前驱和后继，哨兵root的nxt/prv即为最小/最大元素
+        value_type *data;
         
-        Node():data(NULL),fa(NULL),ls(NULL),rs(NULL),h(0){}
-        Node(const value_type& val,Node *_fa=NULL,Node *_ls=NULL,Node *_rs=NULL):data(new value_type(val)),fa(_fa),ls(_ls),rs(_rs),h(1){}
+        Node():ls(NULL),rs(NULL),h(0),sz(0),fa(NULL),prv(this),nxt(this),data(NULL){}
+        Node(const value_type& val,Node *_fa=NULL,Node *_ls=NULL,Node *_rs=NULL):kc(val.first),ls(_ls),rs(_rs),h(1),sz(1),fa(_fa),prv(NULL),nxt(NULL),data(new value_type(val)){}
+        //直接接管已经构造好的val，不再拷贝一次
+        explicit Node(value_type *val):kc(val->first),ls(NULL),rs(NULL),h(1),sz(1),fa(NULL),prv(NULL),nxt(NULL),data(val){}
         ~Node(){if (data) delete data;}
     };
+    //key与结点x的键比较，probe为key_cache(key)：小于返回负数，大于返回正数，相等返回0
+    int compare_key(const key_cache &probe,const Key &key,const Node *x) const
+    {
+        int c=probe.compare(x->kc);
+        if (c!=0 || key_cache::exact) return c;
+        if (Compare()(key,x->data->first)) return -1;
+        if (Compare()(x->data->first,key)) return 1;
+        return 0;
+    }
 
     //map的成员
     Node *root;
     size_t cur_size;
+    //哨兵就放在对象里，root总是指向它，移动和交换都不用分配
+    Node sentinel;
+    //把哨兵from下的整棵树挪到空的哨兵to下
+    static void move_tree(Node *from,Node *to){
+        if (from->ls==NULL) return;
+        to->ls=from->ls;
+        to->ls->fa=to;
+        to->nxt=from->nxt;
+        to->nxt->prv=to;
+        to->prv=from->prv;
+        to->prv->nxt=to;
+        from->ls=NULL;
+        from->nxt=from->prv=from;
+    }
+#ifdef SJTU_STATS
+    map_stats counters;
+    //每个元素是结点和value_type两块
+    void count_alloc(){
+        counters.allocations+=2;
+        counters.bytes_allocated+=sizeof(Node)+sizeof(value_type);
+    }
+#endif
     int get_height(Node *x) const{
 		return (x==NULL?0:x->h);
 	}
+    size_t get_size(Node *x) const{
+		return (x==NULL?0:x->sz);
+	}
+    //高度和子树大小一起维护
     void update_height(Node* x){
 		int lh=get_height(x->ls);
 		int rh=get_height(x->rs);
 		x->h=(lh>rh?lh+1:rh+1);
+		x->sz=get_size(x->ls)+get_size(x->rs)+1;
 	}
-    //给迭代器写的中序遍历：得到第一个元素要一直往左走
-    //得到下一个元素：遍历该元素的右子树，如果右子树存在，则找到右子树的第一个元素（一直往左走），如果右子树不存在，往上找到由左儿子找到的祖先并停
+    //结点在中序中的下标，哨兵root（end()）为cur_size
+    size_t position(Node *x) const {
+        return x==root?cur_size:rank(x->data->first);
+    }
+    //给迭代器写的中序遍历：所有结点按中序用prv/nxt串成一个经过哨兵root的环
+    //插入、删除时顺带维护，旋转不改变中序所以不用管，于是首元素和前驱后继都是O(1)
     Node* get_first() const
     {
-        Node* t=root;
-		while (t->ls!=NULL) t=t->ls;
-		return t;
+        return root->nxt;
     }
     Node* get_last() const
     {
@@ -62,28 +170,37 @@ private:
     Node* get_next(Node *x) const
     {
         if (x==root) return NULL;
-		Node* t=x->rs;
-		if (t!=NULL){
-			while (t->ls!=NULL) t=t->ls;
-			return t;
-		}
-		t=x;
-		while (t->fa->ls!=t) t=t->fa;
-		return t->fa;
+		return x->nxt;
     }
     Node* get_prev(Node *x) const
     {
-        Node* t=x->ls;
-		if (t!=NULL){
-			while (t->rs!=NULL) t=t->rs;
-			return t;
-		}
-		t=x;
-		while (t!=root && t->fa->rs!=t) t=t->fa;
-		return (t==root?NULL:t->fa);
+        return (x->prv==root?NULL:x->prv);
+    }
+    //把x接在pre和suc之间
+    void link(Node *x,Node *pre,Node *suc)
+    {
+        x->prv=pre;
+        x->nxt=suc;
+        pre->nxt=x;
+        suc->prv=x;
+    }
+    void unlink(Node *x)
+    {
+        x->prv->nxt=x->nxt;
+        x->nxt->prv=x->prv;
+    }
+    //按中序重新串起子树x，pre为上一个串上的结点
+    void thread(Node *x,Node *&pre)
+    {
+        if (x==NULL) return;
+        thread(x->ls,pre);
+        link(x,pre,root);
+        pre=x;
+        thread(x->rs,pre);
     }
     //四个旋转函数
     void LL(Node *&x){
+		SJTU_STAT(++counters.rotations;)
 		Node* l=x->ls;
 		Node* par=x->fa;
 		x->ls=l->rs;
@@ -97,6 +214,7 @@ private:
 	}
 	
 	void RR(Node *&x){
+		SJTU_STAT(++counters.rotations;)
 		Node* r=x->rs;
 		Node* par=x->fa;
 		x->rs=r->ls;
@@ -118,34 +236,45 @@ private:
 		LL(x->rs);
 		RR(x);
 	}
-    Node* insert(Node *&x,Node* p,const value_type &val){
+    //把新结点n插入子树x，n的数据已经构造好
+    //pre、suc为沿途最后一次往右、往左走时经过的结点，即新结点的中序前驱和后继
+    Node* insert(Node *&x,Node* p,Node *n,Node *pre,Node *suc){
 		Node* tmp=NULL;
 		if (x==NULL){
-			x=new Node(val,p);
+			x=n;
+			x->fa=p;
+			link(x,pre,suc);
 			return x;
 		}
-		if (Compare()(val.first,x->data->first)){
-			tmp=insert(x->ls,x,val);
+		const Key &key=n->data->first;
+		if (compare_key(n->kc,key,x)<0){
+			tmp=insert(x->ls,x,n,pre,x);
 			if (x->ls->h-get_height(x->rs)>=2){
-				if (Compare()(val.first,x->ls->data->first)) LL(x); else LR(x);
+				if (compare_key(n->kc,key,x->ls)<0) LL(x); else LR(x);
 			}
 		}
 		else{
-			tmp=insert(x->rs,x,val);
+			tmp=insert(x->rs,x,n,x,suc);
 			if (x->rs->h-get_height(x->ls)>=2){
-				if (Compare()(x->rs->data->first,val.first)) RR(x); else RL(x);
+				if (compare_key(n->kc,key,x->rs)>0) RR(x); else RL(x);
 			}
 		}
 		update_height(x);
 		return tmp;
 	}
+	//插入一个键不存在的新元素
+	Node* insert_node(Node *n){
+		SJTU_STAT(count_alloc();)
+		++cur_size;
+		return insert(root->ls,root,n,root,root);
+	}
 
     bool adjust(Node *&x,int dir){
 		int lh=get_height(x->ls);
 		int rh=get_height(x->rs);
 		if (dir==0){
 			if (lh==rh) {update_height(x);return 1;}
-			if (lh==rh-1) return 0;
+			if (lh==rh-1) {update_height(x);return 0;}
 			int rlh=get_height(x->rs->ls);
 			int rrh=get_height(x->rs->rs);
 			if (rlh==rrh) {RR(x);return 0;}
@@ -154,7 +283,7 @@ private:
 		}
 		else{
 			if (lh==rh) {update_height(x);return 1;}
-			if (rh==lh-1) return 0;
+			if (rh==lh-1) {update_height(x);return 0;}
 			int llh=get_height(x->ls->ls);
 			int lrh=get_height(x->ls->rs);
 			if (llh==lrh) {LL(x);return 0;}
@@ -163,6 +292,17 @@ private:
 		}
 	}
 	
+	//从子树x中摘下最小的结点m（不释放），返回x是否变矮
+	bool unlink_min(Node *&x,Node *&m){
+		if (x->ls==NULL){
+			m=x;
+			x=x->rs;
+			if (x!=NULL) x->fa=m->fa;
+			return true;
+		}
+		if (!unlink_min(x->ls,m)) {update_height(x);return false;}
+		else return adjust(x,0);
+	}
 	bool erase(Node *&x,Node* par,const Key& target){
 		if (x==NULL) return false;
 		const Key &cur=x->data->first;
@@ -175,40 +315,61 @@ private:
 				return true;
 			}
 			else{
-				Node* t=x->rs;
-				while (t->ls!=NULL) t=t->ls;
-
-				Node* newNode=new Node(*(t->data),t->fa,NULL,t->rs);
-				update_height(newNode);
-				if (newNode->rs!=NULL) newNode->rs->fa=newNode;
-				if (newNode->fa->ls==t) newNode->fa->ls=newNode;
-				else newNode->fa->rs=newNode;
-				
-				t->fa=x->fa;
+				//把右子树的最小结点t整个挪到x的位置，不拷贝元素也不分配结点
+				Node* r=x->rs;
+				Node* t=NULL;
+				bool shrink=unlink_min(r,t);
+				t->fa=par;
 				t->ls=x->ls;
-				t->rs=x->rs;
-				update_height(t);
+				t->rs=r;
 				t->ls->fa=t;
-				t->rs->fa=t;
-				Node* oldx=x;
+				if (r!=NULL) r->fa=t;
+				delete x;
 				x=t;
-				
-				delete oldx;
-				if (!erase(x->rs,x,x->data->first)) return false;
+				if (!shrink) {update_height(x);return false;}
                 else return adjust(x,1);
 			}
 		}
 		else{
 			if (Compare()(target,x->data->first)){
-				if (!erase(x->ls,x,target)) return false;
+				if (!erase(x->ls,x,target)) {update_height(x);return false;}
                 else return adjust(x,0);
 			}
 			else{
-				if (!erase(x->rs,x,target)) return false;
+				if (!erase(x->rs,x,target)) {update_height(x);return false;}
                 else return adjust(x,1);
 			}
 		}
 	}
+	//第一个不小于key的结点，不存在时返回NULL
+	Node* lower_bound(Node *x,const Key &key) const{
+		Node *res=NULL;
+		key_cache probe(key);
+		while (x!=NULL){
+			if (compare_key(probe,key,x)>0) x=x->rs;
+			else {res=x;x=x->ls;}
+		}
+		return res;
+	}
+	//第一个大于key的结点，不存在时返回NULL
+	Node* upper_bound(Node *x,const Key &key) const{
+		Node *res=NULL;
+		key_cache probe(key);
+		while (x!=NULL){
+			if (compare_key(probe,key,x)<0) {res=x;x=x->ls;}
+			else x=x->rs;
+		}
+		return res;
+	}
+	//中序第k个结点（从0开始），调用前保证k<cur_size
+	Node* select(Node *x,size_t k) const{
+		while (true){
+			size_t ls=get_size(x->ls);
+			if (k<ls) x=x->ls;
+			else if (k==ls) return x;
+			else {k-=ls+1;x=x->rs;}
+		}
+	}
 	
     void copy(Node* &x,Node *p,Node *t)
     {
@@ -217,10 +378,62 @@ private:
             return;
         }
         x=new Node(*(t->data),p);
+        SJTU_STAT(count_alloc();)
         x->h=t->h;
+        x->sz=t->sz;
         copy(x->ls,x,t->ls);
         copy(x->rs,x,t->rs);
     }
+    //把子树x的结点按中序依次放进arr
+    void flatten(Node *x,Node **arr,size_t &cnt)
+    {
+        if (x==NULL) return;
+        flatten(x->ls,arr,cnt);
+        arr[cnt++]=x;
+        flatten(x->rs,arr,cnt);
+    }
+    //用有序的arr[l,r)直接建一棵完全平衡的树，O(r-l)
+    Node* build(Node **arr,size_t l,size_t r,Node *p)
+    {
+        if (l>=r) return NULL;
+        size_t mid=l+(r-l)/2;
+        Node *x=arr[mid];
+        x->fa=p;
+        x->ls=build(arr,l,mid,x);
+        x->rs=build(arr,mid+1,r,x);
+        update_height(x);
+        return x;
+    }
+    //把有序且无重复的结点数组in[0,n)并入树中：中序展开原树后线性归并再重建
+    //键相同时保留原树中的结点，in中的结点释放，返回新增的元素个数
+    //两个数组都先分配好：分配失败时树和in都原样不动，in中的结点仍归调用者
+    size_t merge_nodes(Node **in,size_t n)
+    {
+        size_t old=cur_size,m=0,k=0,i=0,j=0;
+        Node **cur=new Node*[old+1],**all=NULL;
+        try{
+            all=new Node*[old+n+1];
+        }
+        catch(...){
+            delete [] cur;
+            throw;
+        }
+        flatten(root->ls,cur,m);
+        while (i<m && j<n){
+            if (Compare()(cur[i]->data->first,in[j]->data->first)) all[k++]=cur[i++];
+            else if (Compare()(in[j]->data->first,cur[i]->data->first)) all[k++]=in[j++];
+            else delete in[j++];
+        }
+        while (i<m) all[k++]=cur[i++];
+        while (j<n) all[k++]=in[j++];
+        root->ls=build(all,0,k,root);
+        root->nxt=root->prv=root;
+        for (i=0;i<k;++i) link(all[i],root->prv,root);
+        cur_size=k;
+        delete [] cur;
+        delete [] all;
+        return k-old;
+    }
     void make_empty(Node* &x)
     {
         if (!x) return;
@@ -420,13 +633,33 @@ public:
      * TODO two constructors
      */
     map() {
-        root=new Node();
+        root=&sentinel;
+        cur_size=0;
+    }
+    /**
+     * construct from a range of value_type sorted by key, see insert_sorted.
+     */
+    template<class InputIterator>
+    map(InputIterator first,InputIterator last) {
+        root=&sentinel;
         cur_size=0;
+        insert_sorted(first,last);
     }
     map(const map &other) {
-        root=new Node();
+        root=&sentinel;
         cur_size=other.cur_size;
         copy(root->ls,root,other.root->ls);
+        Node *pre=root;
+        thread(root->ls,pre);
+    }
+    /**
+     * move constructor, takes over the tree of other in O(1) without allocating.
+     */
+    map(map &&other) noexcept {
+        root=&sentinel;
+        move_tree(other.root,root);
+        cur_size=other.cur_size;
+        other.cur_size=0;
     }
     /**
      * TODO assignment operator
@@ -436,14 +669,35 @@ public:
         clear();
         cur_size=other.cur_size;
         copy(root->ls,root,other.root->ls);
+        Node *pre=root;
+        thread(root->ls,pre);
+        return *this;
+    }
+    /**
+     * move assignment, releases the old contents and takes over the tree of other.
+     */
+    map & operator=(map &&other) noexcept {
+        if (this==&other) return *this;
+        clear();
+        swap(other);
         return *this;
     }
+    /**
+     * exchanges the contents with other in O(1), no element is copied.
+     */
+    void swap(map &other) noexcept {
+        //哨兵不能交换，树借一个临时哨兵转一手
+        Node tmp;
+        move_tree(root,&tmp);
+        move_tree(other.root,root);
+        move_tree(&tmp,other.root);
+        std::swap(cur_size,other.cur_size);
+    }
     /**
      * TODO Destructors
      */
     ~map() {
         clear();
-        delete root;
     }
     /**
      * TODO
@@ -452,10 +706,13 @@ public:
      * If no such element exists, an exception of type `index_out_of_bound'
      */
     Node* find(Node* x,const Key &key) const {
-        if (x==nullptr) return NULL;
-        if (equal(x->data->first,key)) return x;
-        if (Compare()(key,x->data->first)) return find(x->ls,key);
-        return find(x->rs,key);
+        key_cache probe(key);
+        while (x!=NULL){
+            int c=compare_key(probe,key,x);
+            if (c==0) return x;
+            x=(c<0?x->ls:x->rs);
+        }
+        return NULL;
     }
     T & at(const Key &key) {
         Node* t=find(root->ls,key);
@@ -475,10 +732,7 @@ public:
      */
     T & operator[](const Key &key) {
         Node* t=find(root->ls,key);
-        if (t==NULL) {
-            t=insert(root->ls,root,value_type(key,T()));
-            ++cur_size;
-        }
+        if (t==NULL) t=insert_node(new Node(new value_type(key,T())));
         return t->data->second;
     }
     /**
@@ -526,6 +780,7 @@ public:
      */
     void clear() {
         make_empty(root->ls);
+        root->nxt=root->prv=root;
         cur_size=0;
     }
     /**
@@ -537,10 +792,153 @@ public:
     pair<iterator, bool> insert(const value_type &value) {
         Node* t=find(root->ls,value.first);
         if (t) return {iterator(this,t),false};
-        t=insert(root->ls,root,value);
-        ++cur_size;
+        t=insert_node(new Node(value));
         return {iterator(this,t),true};
     }
+    pair<iterator, bool> insert(value_type &&value) {
+        return emplace(std::move(value));
+    }
+    /**
+     * construct a value_type from args and insert it if its key does not exist yet.
+     * the element is constructed exactly once and never copied afterwards;
+     *   it is destroyed again if the key already exists.
+     * return the same as insert.
+     */
+    template<class... Args>
+    pair<iterator, bool> emplace(Args&&... args) {
+        value_type *val=new value_type(std::forward<Args>(args)...);
+        Node* t=find(root->ls,val->first);
+        if (t) {
+            delete val;
+            return {iterator(this,t),false};
+        }
+        t=insert_node(new Node(val));
+        return {iterator(this,t),true};
+    }
+    /**
+     * if key does not exist, insert an element whose mapped value is constructed from args;
+     *   otherwise do nothing, args are not touched.
+     * return the same as insert.
+     */
+    template<class... Args>
+    pair<iterator, bool> try_emplace(const Key &key,Args&&... args) {
+        Node* t=find(root->ls,key);
+        if (t) return {iterator(this,t),false};
+        t=insert_node(new Node(new value_type(key,T(std::forward<Args>(args)...))));
+        return {iterator(this,t),true};
+    }
+    template<class... Args>
+    pair<iterator, bool> try_emplace(Key &&key,Args&&... args) {
+        Node* t=find(root->ls,key);
+        if (t) return {iterator(this,t),false};
+        t=insert_node(new Node(new value_type(std::move(key),T(std::forward<Args>(args)...))));
+        return {iterator(this,t),true};
+    }
+    /**
+     * assign obj to the mapped value of key, inserting a new element if key does not exist.
+     * return the same as insert, the second one is true if a new element is inserted.
+     */
+    template<class M>
+    pair<iterator, bool> insert_or_assign(const Key &key,M &&obj) {
+        Node* t=find(root->ls,key);
+        if (t) {
+            t->data->second=std::forward<M>(obj);
+            return {iterator(this,t),false};
+        }
+        t=insert_node(new Node(new value_type(key,std::forward<M>(obj))));
+        return {iterator(this,t),true};
+    }
+    template<class M>
+    pair<iterator, bool> insert_or_assign(Key &&key,M &&obj) {
+        Node* t=find(root->ls,key);
+        if (t) {
+            t->data->second=std::forward<M>(obj);
+            return {iterator(this,t),false};
+        }
+        t=insert_node(new Node(new value_type(std::move(key),std::forward<M>(obj))));
+        return {iterator(this,t),true};
+    }
+    /**
+     * insert the elements of [first, last), which should be sorted by key in ascending order.
+     * the tree is rebuilt perfectly balanced in O(size() + n) instead of n separate inserts;
+     *   elements whose key already exists (in this or earlier in the range) are skipped.
+     * if the range turns out not to be sorted, it falls back to inserting one by one.
+     * return the number of elements actually inserted.
+     */
+    template<class InputIterator>
+    size_t insert_sorted(InputIterator first,InputIterator last) {
+        size_t n=0,cap=16,res=0;
+        bool sorted=true;
+        Node **in=new Node*[cap],*t=NULL;
+        try{
+            for (;first!=last;++first){
+                if (n==cap){
+                    Node **tmp=new Node*[cap<<1];
+                    for (size_t i=0;i<n;++i) tmp[i]=in[i];
+                    delete [] in;
+                    in=tmp;
+                    cap<<=1;
+                }
+                t=new Node(*first);
+                SJTU_STAT(count_alloc();)
+                if (n>0 && !Compare()(in[n-1]->data->first,t->data->first)){
+                    if (!Compare()(t->data->first,in[n-1]->data->first)) {delete t;t=NULL;continue;}
+                    sorted=false;
+                }
+                in[n++]=t;
+                t=NULL;
+            }
+        }
+        catch(...){
+            //输入迭代器抛异常时，已读出的节点还没挂到树上
+            delete t;
+            for (size_t i=0;i<n;++i) delete in[i];
+            delete [] in;
+            throw;
+        }
+        size_t i=0;
+        try{
+            if (sorted) res=merge_nodes(in,n);
+            else{
+                for (;i<n;++i){
+                    if (insert(*(in[i]->data)).second) ++res;
+                    delete in[i];
+                }
+            }
+        }
+        catch(...){
+            //merge_nodes只会在动手前抛异常；逐个插入时in[i]及之后的结点还没释放
+            for (;i<n;++i) delete in[i];
+            delete [] in;
+            throw;
+        }
+        delete [] in;
+        return res;
+    }
+    /**
+     * move all the elements of other into this in O(size() + other.size()),
+     *   by flattening both trees in order, merging and rebuilding.
+     * for equivalent keys the element of this is kept.
+     * other becomes empty after the operation, no elements are copied.
+     */
+    void merge(map &&other) {
+        if (this==&other) return;
+        size_t n=0;
+        Node **in=new Node*[other.cur_size+1];
+        flatten(other.root->ls,in,n);
+        //merge_nodes分配失败时什么都没动，other的树还完好，成功后才把它清空
+        try{
+            merge_nodes(in,n);
+        }
+        catch(...){
+            delete [] in;
+            throw;
+        }
+        other.root->ls=NULL;
+        other.root->nxt=other.root->prv=other.root;
+        other.cur_size=0;
+        delete [] in;
+    }
     /**
      * erase the element at pos.
      *
@@ -548,9 +946,28 @@ public:
      */
     void erase(iterator pos) {
         if (pos.ctx!=this || pos.ptn==root || pos.ptn==NULL) throw invalid_iterator();
+        unlink(pos.ptn);
         erase(root->ls,root,pos.ptn->data->first);
         --cur_size;
     }
+    /**
+     * erase the elements in [first, last).
+     * return last.
+     *
+     * throw if first or last does not belong to this, or last is not reachable from first.
+     */
+    iterator erase(iterator first,iterator last) {
+        if (first.ctx!=this || last.ctx!=this || first.ptn==NULL || last.ptn==NULL) throw invalid_iterator();
+        //先确认last不在first之前再删，抛异常时map不变
+        if (position(first.ptn)>position(last.ptn)) throw invalid_iterator();
+        Node *x=first.ptn;
+        while (x!=last.ptn){
+            Node *nxt=x->nxt;
+            erase(iterator(this,x));
+            x=nxt;
+        }
+        return last;
+    }
     /**
      * Returns the number of elements with key
      *   that compares equivalent to the specified argument,
@@ -577,8 +994,94 @@ public:
         if (t) return const_iterator(this,t);
         else return cend(); 
     }
+    /**
+     * returns an iterator to the first element whose key is not less than key,
+     *   or end() if no such element exists.
+     */
+    iterator lower_bound(const Key &key) {
+        Node *t=lower_bound(root->ls,key);
+        return iterator(this,t?t:root);
+    }
+    const_iterator lower_bound(const Key &key) const {
+        Node *t=lower_bound(root->ls,key);
+        return const_iterator(this,t?t:root);
+    }
+    /**
+     * returns an iterator to the first element whose key is greater than key,
+     *   or end() if no such element exists.
+     */
+    iterator upper_bound(const Key &key) {
+        Node *t=upper_bound(root->ls,key);
+        return iterator(this,t?t:root);
+    }
+    const_iterator upper_bound(const Key &key) const {
+        Node *t=upper_bound(root->ls,key);
+        return const_iterator(this,t?t:root);
+    }
+    /**
+     * returns the range [lower_bound(key), upper_bound(key)),
+     *   which contains at most one element.
+     */
+    pair<iterator,iterator> equal_range(const Key &key) {
+        return pair<iterator,iterator>(lower_bound(key),upper_bound(key));
+    }
+    pair<const_iterator,const_iterator> equal_range(const Key &key) const {
+        return pair<const_iterator,const_iterator>(lower_bound(key),upper_bound(key));
+    }
+    /**
+     * returns the number of elements whose key is less than key, in O(logn).
+     */
+    size_t rank(const Key &key) const {
+        size_t res=0;
+        Node *x=root->ls;
+        key_cache probe(key);
+        while (x!=NULL){
+            if (compare_key(probe,key,x)>0) {res+=get_size(x->ls)+1;x=x->rs;}
+            else x=x->ls;
+        }
+        return res;
+    }
+    /**
+     * returns an iterator to the k-th smallest element (counting from 0), in O(logn).
+     * throw index_out_of_bound if k >= size().
+     */
+    iterator select(size_t k) {
+        if (k>=cur_size) throw index_out_of_bound();
+        return iterator(this,select(root->ls,k));
+    }
+    const_iterator select(size_t k) const {
+        if (k>=cur_size) throw index_out_of_bound();
+        return const_iterator(this,select(root->ls,k));
+    }
+    /**
+     * returns an immutable copy of this map laid out for fast lookups.
+     * defined in frozen_map.hpp, which must be included to call it.
+     */
+    frozen_map<Key,T,Compare> freeze() const;
+    /**
+     * returns the bytes held by this map: the object, which holds the sentinel, and one node
+     *   plus one value_type per element. memory owned by the keys and values themselves and
+     *   the allocator's own bookkeeping are not counted.
+     */
+    size_t memory_usage() const {
+        return sizeof(*this)+cur_size*(sizeof(Node)+sizeof(value_type));
+    }
+    /**
+     * returns the counters of this map when compiled with SJTU_STATS, zeros otherwise.
+     */
+    map_stats stats() const {
+        map_stats res;
+        SJTU_STAT(res=counters;)
+        SJTU_STAT(res.height=get_height(root->ls);)
+        return res;
+    }
 };
 
+template<class Key,class T,class Compare>
+void swap(map<Key,T,Compare> &a,map<Key,T,Compare> &b) noexcept {
+    a.swap(b);
+}
+
 }
 
 #endif
\ No newline at end of file
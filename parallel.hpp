@@ -0,0 +1,194 @@
+#ifndef SJTU_PARALLEL_HPP
+#define SJTU_PARALLEL_HPP
+
+#include <cstddef>
+#include <mutex>
+#include "vector.hpp"
+#include "map.hpp"
+#include "linked_hashmap.hpp"
+#include "thread_pool.hpp"
+
+namespace sjtu {
+/**
+ * bulk operations over whole containers running on a thread_pool:
+ *   parallel_for_each  call f on every element
+ *   parallel_transform out[i] = f(in[i]) for vectors
+ *   parallel_reduce    fold every element into one result
+ * vectors are cut into index ranges, maps into rank ranges (found through the subtree sizes
+ *   in O(logn)), linked_hashmaps into bucket ranges.
+ * the container must not be resized while an operation runs; f runs concurrently on
+ *   different elements and must not touch shared state without synchronization.
+ *
+ * parallel_reduce(c, identity, op, combine) folds each chunk with acc = op(acc, x) starting
+ *   from identity, then folds the partial results with combine. identity must be neutral for
+ *   combine, and combine should be associative.
+ * with deterministic = true (the default) the chunks depend only on the size of the container
+ *   and grain, never on the number of workers, and the partial results are combined in chunk
+ *   order, so floating point sums come out bit-identical on every run and every machine.
+ * with deterministic = false there is one chunk per worker and partial results are combined
+ *   as soon as they are ready, which only suits commutative combines.
+ */
+namespace parallel_detail {
+    //每块至少grain个元素；非确定模式下块数不超过线程数
+    inline size_t chunk_count(size_t n, size_t grain, thread_pool &pool, bool deterministic) {
+        if (grain == 0) grain = 1;
+        size_t chunks = (n + grain - 1) / grain;
+        if (!deterministic && chunks > pool.size()) chunks = pool.size();
+        return chunks ? chunks : 1;
+    }
+    //第i块是[begin_of(n, chunks, i), begin_of(n, chunks, i + 1))
+    inline size_t begin_of(size_t n, size_t chunks, size_t i) {
+        return n / chunks * i + (i < n % chunks ? i : n % chunks);
+    }
+    //把[0, n)切成chunks块，每块调用body(lo, hi)，只有一块时直接在当前线程做
+    template<class Body>
+    void run_chunks(size_t n, size_t chunks, thread_pool &pool, Body body) {
+        if (chunks <= 1) {
+            body(size_t(0), n);
+            return;
+        }
+        task_group group(pool);
+        for (size_t i = 0; i < chunks;++i) {
+            size_t lo = begin_of(n, chunks, i), hi = begin_of(n, chunks, i + 1);
+            group.run([&body, lo, hi] { body(lo, hi); });
+        }
+        group.wait();
+    }
+    //fold(lo, hi)返回一块的部分结果，再按要求合并
+    template<class R, class Fold, class Combine>
+    R reduce_chunks(size_t n, const R &identity, Fold fold, Combine combine,
+                    thread_pool &pool, bool deterministic, size_t grain) {
+        size_t chunks = chunk_count(n, grain, pool, deterministic);
+        if (chunks <= 1) return fold(size_t(0), n);
+        if (deterministic) {
+            vector<R> part;
+            part.assign(chunks, identity);
+            task_group group(pool);
+            for (size_t i = 0; i < chunks;++i) {
+                size_t lo = begin_of(n, chunks, i), hi = begin_of(n, chunks, i + 1);
+                R *slot = part.data() + i;
+                group.run([&fold, slot, lo, hi] { *slot = fold(lo, hi); });
+            }
+            group.wait();
+            R res = identity;
+            for (size_t i = 0; i < chunks;++i) res = combine(res, part[i]);
+            return res;
+        }
+        R res = identity;
+        std::mutex mtx;
+        run_chunks(n, chunks, pool, [&](size_t lo, size_t hi) {
+            R r = fold(lo, hi);
+            std::lock_guard<std::mutex> lock(mtx);
+            res = combine(res, r);
+        });
+        return res;
+    }
+}
+
+const size_t PARALLEL_GRAIN = 1 << 12;
+
+template<class T, class F>
+void parallel_for_each(vector<T> &v, F f, thread_pool &pool = thread_pool::shared(),
+                       size_t grain = PARALLEL_GRAIN) {
+    T *a = v.data();
+    size_t n = v.size();
+    parallel_detail::run_chunks(n, parallel_detail::chunk_count(n, grain, pool, false), pool,
+                                [a, &f](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi;++i) f(a[i]);
+    });
+}
+
+/**
+ * out becomes a vector of the same size as in with out[i] = f(in[i]).
+ * U must be default constructible.
+ */
+template<class T, class U, class F>
+void parallel_transform(const vector<T> &in, vector<U> &out, F f,
+                        thread_pool &pool = thread_pool::shared(), size_t grain = PARALLEL_GRAIN) {
+    size_t n = in.size();
+    out.assign(n, U());
+    const T *a = in.data();
+    U *b = out.data();
+    parallel_detail::run_chunks(n, parallel_detail::chunk_count(n, grain, pool, false), pool,
+                                [a, b, &f](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi;++i) b[i] = f(a[i]);
+    });
+}
+
+template<class T, class R, class Op, class Combine>
+R parallel_reduce(const vector<T> &v, const R &identity, Op op, Combine combine,
+                  thread_pool &pool = thread_pool::shared(), bool deterministic = true,
+                  size_t grain = PARALLEL_GRAIN) {
+    const T *a = v.data();
+    return parallel_detail::reduce_chunks(v.size(), identity, [a, &identity, &op](size_t lo, size_t hi) {
+        R acc = identity;
+        for (size_t i = lo; i < hi;++i) acc = op(acc, a[i]);
+        return acc;
+    }, combine, pool, deterministic, grain);
+}
+
+/**
+ * for maps f receives value_type &, so it may modify the mapped values but not the keys.
+ */
+template<class Key, class T, class Compare, class F>
+void parallel_for_each(map<Key, T, Compare> &m, F f, thread_pool &pool = thread_pool::shared(),
+                       size_t grain = PARALLEL_GRAIN) {
+    size_t n = m.size();
+    parallel_detail::run_chunks(n, parallel_detail::chunk_count(n, grain, pool, false), pool,
+                                [&m, &f](size_t lo, size_t hi) {
+        if (lo == hi) return;
+        typename map<Key, T, Compare>::iterator it = m.select(lo);
+        for (size_t i = lo; i < hi;++i, ++it) f(*it);
+    });
+}
+
+/**
+ * op folds the elements of a chunk in key order.
+ */
+template<class Key, class T, class Compare, class R, class Op, class Combine>
+R parallel_reduce(const map<Key, T, Compare> &m, const R &identity, Op op, Combine combine,
+                  thread_pool &pool = thread_pool::shared(), bool deterministic = true,
+                  size_t grain = PARALLEL_GRAIN) {
+    return parallel_detail::reduce_chunks(m.size(), identity, [&m, &identity, &op](size_t lo, size_t hi) {
+        R acc = identity;
+        if (lo == hi) return acc;
+        typename map<Key, T, Compare>::const_iterator it = m.select(lo);
+        for (size_t i = lo; i < hi;++i, ++it) acc = op(acc, *it);
+        return acc;
+    }, combine, pool, deterministic, grain);
+}
+
+/**
+ * linked_hashmaps are cut by buckets, so elements are visited in bucket order rather than
+ *   insertion order, and grain counts buckets instead of elements.
+ * the bucket layout depends on the hash values as well as on the sequence of insertions
+ *   and erasures. with a Hash that is the same in every run (e.g. std::hash) a deterministic
+ *   reduction is reproducible; with a randomly seeded one (hardened_hashmap) the bucket order,
+ *   and so the result of a non-commutative combine, changes from run to run.
+ */
+template<class Key, class T, class Hash, class Equal, class F>
+void parallel_for_each(linked_hashmap<Key, T, Hash, Equal> &m, F f,
+                       thread_pool &pool = thread_pool::shared(), size_t grain = PARALLEL_GRAIN) {
+    size_t n = m.bucket_count();
+    parallel_detail::run_chunks(n, parallel_detail::chunk_count(n, grain, pool, false), pool,
+                                [&m, &f](size_t lo, size_t hi) {
+        m.for_each_bucket(lo, hi, f);
+    });
+}
+
+template<class Key, class T, class Hash, class Equal, class R, class Op, class Combine>
+R parallel_reduce(const linked_hashmap<Key, T, Hash, Equal> &m, const R &identity, Op op, Combine combine,
+                  thread_pool &pool = thread_pool::shared(), bool deterministic = true,
+                  size_t grain = PARALLEL_GRAIN) {
+    return parallel_detail::reduce_chunks(m.bucket_count(), identity, [&m, &identity, &op](size_t lo, size_t hi) {
+        R acc = identity;
+        m.for_each_bucket(lo, hi, [&acc, &op](const typename linked_hashmap<Key, T, Hash, Equal>::value_type &x) {
+            acc = op(acc, x);
+        });
+        return acc;
+    }, combine, pool, deterministic, grain);
+}
+
+}
+
+#endif
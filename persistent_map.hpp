@@ -0,0 +1,414 @@
+#ifndef SJTU_PERSISTENT_MAP_HPP
+#define SJTU_PERSISTENT_MAP_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include "utility.hpp"
+#include "exceptions.hpp"
+#include "map.hpp"
+
+namespace sjtu {
+/**
+ * a sorted map whose copies share structure: an AVL tree of immutable, reference counted
+ *   nodes. copying a persistent_map (or taking a snapshot()) is O(1); an insertion or
+ *   erasure copies only the O(logn) nodes on the path to the changed element, and every
+ *   other copy keeps seeing the old version.
+ * the reference counts are atomic, so different copies may be read, modified and destroyed
+ *   in different threads; a single persistent_map object is not thread-safe by itself.
+ * elements are never modified in place, so there is no non-const operator[]:
+ *   use insert_or_assign to change a mapped value.
+ * iterators stay valid until the persistent_map they came from is modified or destroyed.
+ */
+template<class Key, class T, class Compare = std::less<Key>>
+class persistent_map {
+public:
+    typedef pair<const Key, T> value_type;
+private:
+    class Node {
+    public:
+        value_type data;
+        Node *ls, *rs;
+        int h;
+        std::atomic<size_t> rc;
+        Node(const value_type &val, Node *_ls, Node *_rs) : data(val), ls(_ls), rs(_rs), rc(1) {}
+        template<class K, class V>
+        Node(K &&k, V &&v, Node *_ls, Node *_rs)
+            : data(std::forward<K>(k), std::forward<V>(v)), ls(_ls), rs(_rs), rc(1) {}
+    };
+    Node *root;
+    size_t cur_size;
+
+    static int get_height(const Node *x) {
+        return x == nullptr ? 0 : x->h;
+    }
+    static void retain(Node *x) {
+        if (x) x->rc.fetch_add(1, std::memory_order_relaxed);
+    }
+    //引用计数归零时释放，子树各自减一
+    static void release(Node *x) {
+        if (x && x->rc.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            release(x->ls);
+            release(x->rs);
+            delete x;
+        }
+    }
+    //新建结点，ls和rs的引用计数加一，调用者手里原有的引用不变
+    static Node *make(const value_type &val, Node *ls, Node *rs) {
+        retain(ls);
+        retain(rs);
+        return adopt(new Node(val, ls, rs));
+    }
+    //新结点已经挂好了孩子，只需算出高度
+    static Node *adopt(Node *x) {
+        int lh = get_height(x->ls), rh = get_height(x->rs);
+        x->h = (lh > rh ? lh : rh) + 1;
+        return x;
+    }
+    //以val为根、ls和rs为左右子树建一个平衡的结点，不平衡时旋转（旋转也是新建结点）
+    static Node *balance(const value_type &val, Node *ls, Node *rs) {
+        int lh = get_height(ls), rh = get_height(rs);
+        if (lh > rh + 1) {
+            Node *a, *b, *res;
+            if (get_height(ls->ls) >= get_height(ls->rs)) {
+                b = make(val, ls->rs, rs);
+                res = make(ls->data, ls->ls, b);
+                release(b);
+            }
+            else {
+                Node *m = ls->rs;
+                a = make(ls->data, ls->ls, m->ls);
+                b = make(val, m->rs, rs);
+                res = make(m->data, a, b);
+                release(a);
+                release(b);
+            }
+            return res;
+        }
+        if (rh > lh + 1) {
+            Node *a, *b, *res;
+            if (get_height(rs->rs) >= get_height(rs->ls)) {
+                a = make(val, ls, rs->ls);
+                res = make(rs->data, a, rs->rs);
+                release(a);
+            }
+            else {
+                Node *m = rs->ls;
+                a = make(val, ls, m->ls);
+                b = make(rs->data, m->rs, rs->rs);
+                res = make(m->data, a, b);
+                release(a);
+                release(b);
+            }
+            return res;
+        }
+        return make(val, ls, rs);
+    }
+    //插入一个不存在的键，或者替换已存在的键的值，返回新树的根（调用者持有一个引用）
+    template<class K, class V>
+    static Node *insert(Node *x, K &&key, V &&value) {
+        if (x == nullptr) return adopt(new Node(std::forward<K>(key), std::forward<V>(value), nullptr, nullptr));
+        Compare cmp;
+        Node *sub, *res;
+        if (cmp(key, x->data.first)) {
+            sub = insert(x->ls, std::forward<K>(key), std::forward<V>(value));
+            res = balance(x->data, sub, x->rs);
+        }
+        else if (cmp(x->data.first, key)) {
+            sub = insert(x->rs, std::forward<K>(key), std::forward<V>(value));
+            res = balance(x->data, x->ls, sub);
+        }
+        else {
+            //键相同：只换值，形状不变
+            retain(x->ls);
+            retain(x->rs);
+            return adopt(new Node(x->data.first, std::forward<V>(value), x->ls, x->rs));
+        }
+        release(sub);
+        return res;
+    }
+    //删除子树中最小的元素，返回新子树的根
+    static Node *erase_min(Node *x) {
+        if (x->ls == nullptr) {
+            retain(x->rs);
+            return x->rs;
+        }
+        Node *sub = erase_min(x->ls);
+        Node *res = balance(x->data, sub, x->rs);
+        release(sub);
+        return res;
+    }
+    //删除一个存在的键，返回新树的根
+    static Node *erase(Node *x, const Key &key) {
+        Compare cmp;
+        Node *sub, *res;
+        if (cmp(key, x->data.first)) {
+            sub = erase(x->ls, key);
+            res = balance(x->data, sub, x->rs);
+        }
+        else if (cmp(x->data.first, key)) {
+            sub = erase(x->rs, key);
+            res = balance(x->data, x->ls, sub);
+        }
+        else {
+            if (x->ls == nullptr || x->rs == nullptr) {
+                Node *child = (x->ls == nullptr ? x->rs : x->ls);
+                retain(child);
+                return child;
+            }
+            //右子树的最小元素顶上来
+            Node *m = x->rs;
+            while (m->ls != nullptr) m = m->ls;
+            sub = erase_min(x->rs);
+            res = balance(m->data, x->ls, sub);
+        }
+        release(sub);
+        return res;
+    }
+    Node *find_node(const Key &key) const {
+        Compare cmp;
+        Node *x = root;
+        while (x != nullptr) {
+            if (cmp(key, x->data.first)) x = x->ls;
+            else if (cmp(x->data.first, key)) x = x->rs;
+            else return x;
+        }
+        return nullptr;
+    }
+    //用有序序列的n个元素建一棵完全平衡的树
+    template<class Iterator>
+    static Node *build(Iterator &it, size_t n) {
+        if (n == 0) return nullptr;
+        size_t m = n / 2;
+        Node *ls = build(it, m);
+        Node *x = new Node(*it, ls, nullptr);
+        ++it;
+        x->rs = build(it, n - m - 1);
+        return adopt(x);
+    }
+public:
+    /**
+     * an iterator keeps the path from the root to its element,
+     *   since shared nodes cannot point back to their parents.
+     */
+    class const_iterator {
+        friend class persistent_map;
+    private:
+        //AVL的高度不超过1.44log(n+2)，96层足够
+        static const int MAX_DEPTH = 96;
+        const Node *rt;
+        const Node *stk[MAX_DEPTH];
+        int d;
+        void push_left(const Node *x) {
+            for (; x != nullptr; x = x->ls) stk[d++] = x;
+        }
+        void push_right(const Node *x) {
+            for (; x != nullptr; x = x->rs) stk[d++] = x;
+        }
+        const_iterator(const Node *_rt) : rt(_rt), d(0) {}
+    public:
+        const_iterator() : rt(nullptr), d(0) {}
+        const_iterator(const const_iterator &other) : rt(other.rt), d(other.d) {
+            for (int i = 0; i < d;++i) stk[i] = other.stk[i];
+        }
+        const_iterator &operator=(const const_iterator &other) {
+            rt = other.rt;
+            d = other.d;
+            for (int i = 0; i < d;++i) stk[i] = other.stk[i];
+            return *this;
+        }
+        /**
+         * throw invalid_iterator when moving past the end or before the beginning.
+         */
+        const_iterator &operator++() {
+            if (d == 0) throw invalid_iterator();
+            const Node *x = stk[d - 1];
+            if (x->rs != nullptr) push_left(x->rs);
+            else {
+                //一路弹栈直到从左子树回来
+                const Node *c;
+                do c = stk[--d]; while (d > 0 && stk[d - 1]->rs == c);
+            }
+            return *this;
+        }
+        const_iterator operator++(int) {
+            const_iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+        const_iterator &operator--() {
+            if (d == 0) {
+                if (rt == nullptr) throw invalid_iterator();
+                push_right(rt);
+                return *this;
+            }
+            const Node *x = stk[d - 1];
+            if (x->ls != nullptr) push_right(x->ls);
+            else {
+                int k = d;
+                const Node *c;
+                do c = stk[--k]; while (k > 0 && stk[k - 1]->ls == c);
+                if (k == 0) throw invalid_iterator();
+                d = k;
+            }
+            return *this;
+        }
+        const_iterator operator--(int) {
+            const_iterator tmp = *this;
+            --*this;
+            return tmp;
+        }
+        const value_type &operator*() const {
+            if (d == 0) throw invalid_iterator();
+            return stk[d - 1]->data;
+        }
+        const value_type *operator->() const {
+            return &**this;
+        }
+        bool operator==(const const_iterator &rhs) const {
+            if (rt != rhs.rt || d != rhs.d) return false;
+            return d == 0 || stk[d - 1] == rhs.stk[d - 1];
+        }
+        bool operator!=(const const_iterator &rhs) const {
+            return !(*this == rhs);
+        }
+    };
+    typedef const_iterator iterator;
+
+    persistent_map() : root(nullptr), cur_size(0) {}
+    /**
+     * build from the elements of m in O(size()).
+     */
+    explicit persistent_map(const map<Key, T, Compare> &m) : cur_size(m.size()) {
+        typename map<Key, T, Compare>::const_iterator it = m.cbegin();
+        root = build(it, cur_size);
+    }
+    /**
+     * O(1), shares all the nodes with other.
+     */
+    persistent_map(const persistent_map &other) : root(other.root), cur_size(other.cur_size) {
+        retain(root);
+    }
+    persistent_map(persistent_map &&other) noexcept : root(other.root), cur_size(other.cur_size) {
+        other.root = nullptr;
+        other.cur_size = 0;
+    }
+    persistent_map &operator=(persistent_map other) noexcept {
+        swap(other);
+        return *this;
+    }
+    ~persistent_map() {
+        release(root);
+    }
+    void swap(persistent_map &other) noexcept {
+        std::swap(root, other.root);
+        std::swap(cur_size, other.cur_size);
+    }
+    /**
+     * returns the current version of the map in O(1); later changes to either map
+     *   are not seen by the other.
+     */
+    persistent_map snapshot() const {
+        return *this;
+    }
+    size_t size() const {
+        return cur_size;
+    }
+    bool empty() const {
+        return cur_size == 0;
+    }
+    void clear() {
+        release(root);
+        root = nullptr;
+        cur_size = 0;
+    }
+    const_iterator begin() const {
+        const_iterator it(root);
+        it.push_left(root);
+        return it;
+    }
+    const_iterator cbegin() const {
+        return begin();
+    }
+    const_iterator end() const {
+        return const_iterator(root);
+    }
+    const_iterator cend() const {
+        return end();
+    }
+    /**
+     * returns an iterator to the element with key, or end() if it does not exist.
+     */
+    const_iterator find(const Key &key) const {
+        Compare cmp;
+        const_iterator it(root);
+        const Node *x = root;
+        while (x != nullptr) {
+            it.stk[it.d++] = x;
+            if (cmp(key, x->data.first)) x = x->ls;
+            else if (cmp(x->data.first, key)) x = x->rs;
+            else return it;
+        }
+        return end();
+    }
+    size_t count(const Key &key) const {
+        return find_node(key) ? 1 : 0;
+    }
+    /**
+     * throw index_out_of_bound if key does not exist.
+     */
+    const T &at(const Key &key) const {
+        Node *x = find_node(key);
+        if (x == nullptr) throw index_out_of_bound();
+        return x->data.second;
+    }
+    const T &operator[](const Key &key) const {
+        return at(key);
+    }
+    /**
+     * insert value if its key does not exist yet.
+     * return true if inserted; nothing is copied if the key exists.
+     */
+    bool insert(const value_type &value) {
+        if (find_node(value.first)) return false;
+        Node *nr = insert(root, value.first, value.second);
+        release(root);
+        root = nr;
+        ++cur_size;
+        return true;
+    }
+    /**
+     * set the mapped value of key to obj, inserting key if it does not exist.
+     * return true if a new element was inserted.
+     */
+    template<class M>
+    bool insert_or_assign(const Key &key, M &&obj) {
+        bool fresh = (find_node(key) == nullptr);
+        Node *nr = insert(root, key, std::forward<M>(obj));
+        release(root);
+        root = nr;
+        if (fresh) ++cur_size;
+        return fresh;
+    }
+    /**
+     * remove the element with key if it exists, return the number of elements removed.
+     */
+    size_t erase(const Key &key) {
+        if (!find_node(key)) return 0;
+        Node *nr = erase(root, key);
+        release(root);
+        root = nr;
+        --cur_size;
+        return 1;
+    }
+};
+
+template<class Key, class T, class Compare>
+void swap(persistent_map<Key, T, Compare> &a, persistent_map<Key, T, Compare> &b) noexcept {
+    a.swap(b);
+}
+
+}
+
+#endif
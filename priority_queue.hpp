@@ -3,7 +3,9 @@
 
 #include <cstddef>
 #include <functional>
+#include <utility>
 #include "exceptions.hpp"
+#include "stats.hpp"
 
 namespace sjtu {
 
@@ -37,30 +39,53 @@ public:
     };
     node *root;
     size_t cur_size;
+#ifdef SJTU_STATS
+private:
+    priority_queue_stats counters;
+    //每个元素是结点和T两块
+    void count_node() {
+        counters.allocations += 2;
+        counters.bytes_allocated += sizeof(node) + sizeof(T);
+    }
+    //before为这次合并之前merge_steps的值，左偏树上一次合并的递归是一条链，调用次数就是深度
+    void count_merge(size_t before) {
+        ++counters.merges;
+        size_t depth = counters.merge_steps - before;
+        if (depth > counters.max_merge_depth) counters.max_merge_depth = depth;
+    }
+public:
+#endif
     /**
 	 * TODO constructors
 	 */
 private:
+    //左链可能有O(n)长，只有右路径是O(logn)的，所以只对右儿子递归，沿左儿子循环
     void dfs(node* n,node* _n)
     {
         node *tmp;
-        tmp = _n->lson;
-        if (tmp) {
+        while (true) {
+            tmp = _n->rson;
+            if (tmp) {
+                n->rson = new node(*(tmp->data), tmp->npl, n);
+                SJTU_STAT(count_node();)
+                dfs(n->rson, tmp);
+            }
+            tmp = _n->lson;
+            if (!tmp) break;
             n->lson = new node(*(tmp->data), tmp->npl, n);
-            dfs(n->lson, tmp);
-        }
-        tmp = _n->rson;
-        if (tmp) {
-            n->rson = new node(*(tmp->data), tmp->npl, n);
-            dfs(n->rson, tmp);
+            SJTU_STAT(count_node();)
+            n = n->lson;
+            _n = tmp;
         }
     }
     void clear(node *n)
     {
-        if (!n) return;
-        if (n->lson) clear(n->lson);
-        if (n->rson) clear(n->rson);
-        delete n;
+        while (n) {
+            if (n->rson) clear(n->rson);
+            node *tmp = n->lson;
+            delete n;
+            n = tmp;
+        }
     }
     void swap(node *&rt1,node *&rt2)
     {
@@ -69,16 +94,16 @@ private:
     }
     node* merge_(node *&rt1,node *&rt2)
     {
+        SJTU_STAT(++counters.merge_steps;)
         if (!rt1) return rt2;
         if (!rt2) return rt1;
+        //保证rt1不小于rt2，相等时随便哪个当根都行
         if (Compare()(*(rt1->data),*(rt2->data))) swap(rt1, rt2);
-        if (Compare()(*(rt2->data),*(rt1->data))) {
-            rt1->rson = merge_(rt1->rson, rt2);
-            if (rt1->lson==nullptr || rt1->lson->npl<rt1->rson->npl) swap(rt1->lson, rt1->rson);
-            if (rt1->rson) rt1->npl = rt1->rson->npl + 1;
-            else rt1->npl = 0;
-            return rt1;
-        }
+        rt1->rson = merge_(rt1->rson, rt2);
+        if (rt1->lson==nullptr || rt1->lson->npl<rt1->rson->npl) swap(rt1->lson, rt1->rson);
+        if (rt1->rson) rt1->npl = rt1->rson->npl + 1;
+        else rt1->npl = 0;
+        return rt1;
     }
 public:
 	priority_queue() {
@@ -87,8 +112,20 @@ public:
     }
 	priority_queue(const priority_queue &other) {
         cur_size = other.cur_size;
+        root = nullptr;
+        if (!other.root) return;
         root = new node(*(other.root->data), other.root->npl, nullptr);
+        SJTU_STAT(count_node();)
         dfs(root, other.root);
+    }
+	/**
+	 * move constructor, takes over the heap of other in O(1).
+	 */
+	priority_queue(priority_queue &&other) noexcept {
+        root = other.root;
+        cur_size = other.cur_size;
+        other.root = nullptr;
+        other.cur_size = 0;
     }
 	/**
 	 * TODO deconstructor
@@ -104,9 +141,32 @@ public:
             return *this;
         clear(root);
         cur_size = other.cur_size;
+        root = nullptr;
+        if (!other.root) return *this;
         root = new node(*(other.root->data), other.root->npl, nullptr);
+        SJTU_STAT(count_node();)
         dfs(root, other.root);
         return *this;
+    }
+	/**
+	 * move assignment, releases the old contents and takes over the heap of other.
+	 */
+	priority_queue &operator=(priority_queue &&other) noexcept {
+        if (this==&other)
+            return *this;
+        clear(root);
+        root = other.root;
+        cur_size = other.cur_size;
+        other.root = nullptr;
+        other.cur_size = 0;
+        return *this;
+    }
+	/**
+	 * exchanges the contents with other in O(1), no element is copied.
+	 */
+	void swap(priority_queue &other) noexcept {
+        std::swap(root, other.root);
+        std::swap(cur_size, other.cur_size);
     }
 	/**
 	 * get the top of the queue.
@@ -124,7 +184,10 @@ public:
 	void push(const T &e) {
         T ee = e;
         node *tmp = new node(ee, 0,nullptr);
+        SJTU_STAT(count_node();)
+        SJTU_STAT(size_t before = counters.merge_steps;)
         root=merge_(root,tmp);
+        SJTU_STAT(count_merge(before);)
         ++cur_size;
     }
 	/**
@@ -136,7 +199,9 @@ public:
         if (empty()) throw container_is_empty();
         node *tmp = root;
         root = root->lson;
+        SJTU_STAT(size_t before = counters.merge_steps;)
         root = merge_(root, tmp->rson);
+        SJTU_STAT(count_merge(before);)
         --cur_size;
         delete tmp;
     }
@@ -145,6 +210,14 @@ public:
 	 */
 	size_t size() const {
         return cur_size;
+    }
+	/**
+	 * returns the counters of this queue when compiled with SJTU_STATS, zeros otherwise.
+	 */
+	priority_queue_stats stats() const {
+        priority_queue_stats res;
+        SJTU_STAT(res = counters;)
+        return res;
     }
 	/**
 	 * check if the container has at least an element.
@@ -159,13 +232,20 @@ public:
 	 * clear the other priority_queue.
 	 */
 	void merge(priority_queue &other) {
+        SJTU_STAT(size_t before = counters.merge_steps;)
         root=merge_(root, other.root);
+        SJTU_STAT(count_merge(before);)
         cur_size += other.cur_size;
         other.cur_size = 0;
         other.root = nullptr;
     }
 };
 
+template<typename T, class Compare>
+void swap(priority_queue<T, Compare> &a, priority_queue<T, Compare> &b) noexcept {
+    a.swap(b);
+}
+
 }
 
 #endif
\ No newline at end of file
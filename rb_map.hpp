@@ -0,0 +1,535 @@
+#ifndef SJTU_RB_MAP_HPP
+#define SJTU_RB_MAP_HPP
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include "utility.hpp"
+#include "exceptions.hpp"
+#include "stats.hpp"
+
+namespace sjtu {
+/**
+ * a sorted map balanced as a red-black tree, for workloads with about as many erasures as
+ *   insertions. an insertion does at most two rotations and an erasure at most three,
+ *   where map (an AVL tree) may rotate on every level on the way back up after an erasure;
+ *   in exchange the tree may be up to 2log(n) high instead of 1.44log(n).
+ * the element is stored in the node, so an element is a single heap block, and erasing
+ *   relinks nodes without copying or allocating.
+ * it supports the common operations of map, without rank/select.
+ * iterators stay valid until their element is erased.
+ */
+template<class Key, class T, class Compare = std::less<Key>>
+class rb_map {
+public:
+    typedef pair<const Key, T> value_type;
+private:
+    class Node {
+    public:
+        value_type data;
+        Node *fa, *ls, *rs;
+        bool red;
+        template<class... Args>
+        explicit Node(Args&&... args)
+            : data(std::forward<Args>(args)...), fa(nullptr), ls(nullptr), rs(nullptr), red(true) {}
+    };
+    Node *root;
+    size_t cur_size;
+#ifdef SJTU_STATS
+    map_stats counters;
+    void count_alloc() {
+        ++counters.allocations;
+        counters.bytes_allocated += sizeof(Node);
+    }
+#endif
+
+    static bool is_red(const Node *x) {
+        return x != nullptr && x->red;
+    }
+    static Node *minimum(Node *x) {
+        while (x->ls != nullptr) x = x->ls;
+        return x;
+    }
+    static Node *maximum(Node *x) {
+        while (x->rs != nullptr) x = x->rs;
+        return x;
+    }
+    static Node *successor(Node *x) {
+        if (x->rs != nullptr) return minimum(x->rs);
+        while (x->fa != nullptr && x->fa->rs == x) x = x->fa;
+        return x->fa;
+    }
+    static Node *predecessor(Node *x) {
+        if (x->ls != nullptr) return maximum(x->ls);
+        while (x->fa != nullptr && x->fa->ls == x) x = x->fa;
+        return x->fa;
+    }
+    //用v顶替u在父亲那里的位置
+    void transplant(Node *u, Node *v) {
+        if (u->fa == nullptr) root = v;
+        else if (u == u->fa->ls) u->fa->ls = v;
+        else u->fa->rs = v;
+        if (v != nullptr) v->fa = u->fa;
+    }
+    void rotate_left(Node *x) {
+        SJTU_STAT(++counters.rotations;)
+        Node *y = x->rs;
+        x->rs = y->ls;
+        if (y->ls != nullptr) y->ls->fa = x;
+        transplant(x, y);
+        y->ls = x;
+        x->fa = y;
+    }
+    void rotate_right(Node *x) {
+        SJTU_STAT(++counters.rotations;)
+        Node *y = x->ls;
+        x->ls = y->rs;
+        if (y->rs != nullptr) y->rs->fa = x;
+        transplant(x, y);
+        y->rs = x;
+        x->fa = y;
+    }
+    //新插入的红结点z可能和父亲都是红的，向上把红色推走
+    void insert_fixup(Node *z) {
+        while (is_red(z->fa)) {
+            Node *p = z->fa, *g = p->fa;
+            if (p == g->ls) {
+                Node *u = g->rs;
+                if (is_red(u)) {
+                    p->red = u->red = false;
+                    g->red = true;
+                    z = g;
+                    continue;
+                }
+                if (z == p->rs) {
+                    rotate_left(p);
+                    z = p;
+                    p = z->fa;
+                }
+                p->red = false;
+                g->red = true;
+                rotate_right(g);
+            }
+            else {
+                Node *u = g->ls;
+                if (is_red(u)) {
+                    p->red = u->red = false;
+                    g->red = true;
+                    z = g;
+                    continue;
+                }
+                if (z == p->ls) {
+                    rotate_right(p);
+                    z = p;
+                    p = z->fa;
+                }
+                p->red = false;
+                g->red = true;
+                rotate_left(g);
+            }
+        }
+        root->red = false;
+    }
+    //x所在的子树少了一个黑结点，xp为x的父亲（x可能为空）
+    void erase_fixup(Node *x, Node *xp) {
+        while (x != root && !is_red(x)) {
+            if (x == xp->ls) {
+                Node *w = xp->rs;
+                if (w->red) {
+                    w->red = false;
+                    xp->red = true;
+                    rotate_left(xp);
+                    w = xp->rs;
+                }
+                if (!is_red(w->ls) && !is_red(w->rs)) {
+                    w->red = true;
+                    x = xp;
+                    xp = xp->fa;
+                    continue;
+                }
+                if (!is_red(w->rs)) {
+                    w->ls->red = false;
+                    w->red = true;
+                    rotate_right(w);
+                    w = xp->rs;
+                }
+                w->red = xp->red;
+                xp->red = false;
+                w->rs->red = false;
+                rotate_left(xp);
+            }
+            else {
+                Node *w = xp->ls;
+                if (w->red) {
+                    w->red = false;
+                    xp->red = true;
+                    rotate_right(xp);
+                    w = xp->ls;
+                }
+                if (!is_red(w->ls) && !is_red(w->rs)) {
+                    w->red = true;
+                    x = xp;
+                    xp = xp->fa;
+                    continue;
+                }
+                if (!is_red(w->ls)) {
+                    w->rs->red = false;
+                    w->red = true;
+                    rotate_left(w);
+                    w = xp->ls;
+                }
+                w->red = xp->red;
+                xp->red = false;
+                w->ls->red = false;
+                rotate_right(xp);
+            }
+            x = root;
+        }
+        if (x != nullptr) x->red = false;
+    }
+    //摘下z并释放；有两个孩子时把后继结点挪到z的位置
+    void erase_node(Node *z) {
+        Node *x, *xp;
+        bool removed_red = z->red;
+        if (z->ls == nullptr || z->rs == nullptr) {
+            x = (z->ls == nullptr ? z->rs : z->ls);
+            xp = z->fa;
+            transplant(z, x);
+        }
+        else {
+            Node *y = minimum(z->rs);
+            removed_red = y->red;
+            x = y->rs;
+            if (y->fa == z) xp = y;
+            else {
+                xp = y->fa;
+                transplant(y, y->rs);
+                y->rs = z->rs;
+                y->rs->fa = y;
+            }
+            transplant(z, y);
+            y->ls = z->ls;
+            y->ls->fa = y;
+            y->red = z->red;
+        }
+        delete z;
+        --cur_size;
+        if (!removed_red) erase_fixup(x, xp);
+    }
+    Node *find_node(const Key &key) const {
+        Node *x = root;
+        while (x != nullptr) {
+            if (Compare()(key, x->data.first)) x = x->ls;
+            else if (Compare()(x->data.first, key)) x = x->rs;
+            else return x;
+        }
+        return nullptr;
+    }
+    //第一个不小于（upper时为大于）key的结点，不存在时返回nullptr
+    Node *bound(const Key &key, bool upper) const {
+        Node *x = root, *res = nullptr;
+        while (x != nullptr) {
+            if (upper ? Compare()(key, x->data.first) : !Compare()(x->data.first, key)) {
+                res = x;
+                x = x->ls;
+            }
+            else x = x->rs;
+        }
+        return res;
+    }
+    //找key，不存在时用args构造一个新结点插进去；second表示是否新插入
+    template<class... Args>
+    pair<Node *, bool> insert_key(const Key &key, Args&&... args) {
+        Node *x = root, *p = nullptr;
+        bool left = false;
+        while (x != nullptr) {
+            p = x;
+            if (Compare()(key, x->data.first)) x = x->ls, left = true;
+            else if (Compare()(x->data.first, key)) x = x->rs, left = false;
+            else return pair<Node *, bool>(x, false);
+        }
+        Node *z = new Node(std::forward<Args>(args)...);
+        SJTU_STAT(count_alloc();)
+        z->fa = p;
+        if (p == nullptr) root = z;
+        else if (left) p->ls = z;
+        else p->rs = z;
+        ++cur_size;
+        insert_fixup(z);
+        return pair<Node *, bool>(z, true);
+    }
+    Node *copy(const Node *t, Node *fa) {
+        if (t == nullptr) return nullptr;
+        Node *x = new Node(t->data);
+        SJTU_STAT(count_alloc();)
+        x->fa = fa;
+        x->red = t->red;
+        try {
+            x->ls = copy(t->ls, x);
+            x->rs = copy(t->rs, x);
+        }
+        catch (...) {
+            clear(x);
+            throw;
+        }
+        return x;
+    }
+    static void clear(Node *x) {
+        if (x == nullptr) return;
+        clear(x->ls);
+        clear(x->rs);
+        delete x;
+    }
+    static int height(const Node *x) {
+        if (x == nullptr) return 0;
+        int lh = height(x->ls), rh = height(x->rs);
+        return (lh > rh ? lh : rh) + 1;
+    }
+
+public:
+    class iterator;
+    /**
+     * a null node is end(); -- on end() goes to the last element.
+     */
+    class const_iterator {
+        friend class rb_map;
+    protected:
+        const rb_map *ctx;
+        Node *ptn;
+        const_iterator(const rb_map *_ctx, Node *_ptn) : ctx(_ctx), ptn(_ptn) {}
+    public:
+        const_iterator() : ctx(nullptr), ptn(nullptr) {}
+        /**
+         * throw invalid_iterator when moving past the end or before the beginning.
+         */
+        const_iterator &operator++() {
+            if (ptn == nullptr) throw invalid_iterator();
+            ptn = successor(ptn);
+            return *this;
+        }
+        const_iterator operator++(int) {
+            const_iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+        const_iterator &operator--() {
+            if (ctx == nullptr) throw invalid_iterator();
+            Node *p;
+            if (ptn == nullptr) p = (ctx->root == nullptr ? nullptr : maximum(ctx->root));
+            else p = predecessor(ptn);
+            if (p == nullptr) throw invalid_iterator();
+            ptn = p;
+            return *this;
+        }
+        const_iterator operator--(int) {
+            const_iterator tmp = *this;
+            --*this;
+            return tmp;
+        }
+        const value_type &operator*() const {
+            if (ptn == nullptr) throw invalid_iterator();
+            return ptn->data;
+        }
+        const value_type *operator->() const {
+            return &**this;
+        }
+        bool operator==(const const_iterator &rhs) const {
+            return ctx == rhs.ctx && ptn == rhs.ptn;
+        }
+        bool operator!=(const const_iterator &rhs) const {
+            return !(*this == rhs);
+        }
+    };
+    class iterator : public const_iterator {
+        friend class rb_map;
+    private:
+        iterator(const rb_map *_ctx, Node *_ptn) : const_iterator(_ctx, _ptn) {}
+    public:
+        iterator() {}
+        iterator &operator++() {
+            const_iterator::operator++();
+            return *this;
+        }
+        iterator operator++(int) {
+            iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+        iterator &operator--() {
+            const_iterator::operator--();
+            return *this;
+        }
+        iterator operator--(int) {
+            iterator tmp = *this;
+            --*this;
+            return tmp;
+        }
+        value_type &operator*() const {
+            if (this->ptn == nullptr) throw invalid_iterator();
+            return this->ptn->data;
+        }
+        value_type *operator->() const {
+            return &**this;
+        }
+    };
+
+    rb_map() : root(nullptr), cur_size(0) {}
+    rb_map(const rb_map &other) : root(nullptr), cur_size(0) {
+        root = copy(other.root, nullptr);
+        cur_size = other.cur_size;
+    }
+    rb_map(rb_map &&other) noexcept : root(other.root), cur_size(other.cur_size) {
+        other.root = nullptr;
+        other.cur_size = 0;
+    }
+    rb_map &operator=(const rb_map &other) {
+        if (this == &other) return *this;
+        rb_map tmp(other);
+        swap(tmp);
+        return *this;
+    }
+    rb_map &operator=(rb_map &&other) noexcept {
+        if (this == &other) return *this;
+        clear();
+        swap(other);
+        return *this;
+    }
+    ~rb_map() {
+        clear(root);
+    }
+    void swap(rb_map &other) noexcept {
+        std::swap(root, other.root);
+        std::swap(cur_size, other.cur_size);
+    }
+    size_t size() const {
+        return cur_size;
+    }
+    bool empty() const {
+        return cur_size == 0;
+    }
+    void clear() {
+        clear(root);
+        root = nullptr;
+        cur_size = 0;
+    }
+    /**
+     * access specified element with bounds checking
+     * throw index_out_of_bound if such key does not exist.
+     */
+    T &at(const Key &key) {
+        Node *x = find_node(key);
+        if (x == nullptr) throw index_out_of_bound();
+        return x->data.second;
+    }
+    const T &at(const Key &key) const {
+        Node *x = find_node(key);
+        if (x == nullptr) throw index_out_of_bound();
+        return x->data.second;
+    }
+    /**
+     * performing an insertion if such key does not already exist.
+     */
+    T &operator[](const Key &key) {
+        Node *x = find_node(key);
+        if (x == nullptr) x = insert_key(key, key, T()).first;
+        return x->data.second;
+    }
+    const T &operator[](const Key &key) const {
+        return at(key);
+    }
+    /**
+     * return a pair, the first of the pair is
+     *   the iterator to the new element (or the element that prevented the insertion),
+     *   the second one is true if insert successfully, or false.
+     */
+    pair<iterator, bool> insert(const value_type &value) {
+        pair<Node *, bool> res = insert_key(value.first, value);
+        return pair<iterator, bool>(iterator(this, res.first), res.second);
+    }
+    /**
+     * if key does not exist, insert an element whose mapped value is constructed from args.
+     */
+    template<class... Args>
+    pair<iterator, bool> try_emplace(const Key &key, Args&&... args) {
+        Node *x = find_node(key);
+        if (x != nullptr) return pair<iterator, bool>(iterator(this, x), false);
+        x = insert_key(key, key, T(std::forward<Args>(args)...)).first;
+        return pair<iterator, bool>(iterator(this, x), true);
+    }
+    /**
+     * throw invalid_iterator if pos is end() or does not belong to this map.
+     */
+    void erase(const_iterator pos) {
+        if (pos.ctx != this || pos.ptn == nullptr) throw invalid_iterator();
+        erase_node(pos.ptn);
+    }
+    /**
+     * remove the element with key, returns the number of elements removed (0 or 1).
+     */
+    size_t erase(const Key &key) {
+        Node *x = find_node(key);
+        if (x == nullptr) return 0;
+        erase_node(x);
+        return 1;
+    }
+    size_t count(const Key &key) const {
+        return find_node(key) == nullptr ? 0 : 1;
+    }
+    iterator find(const Key &key) {
+        return iterator(this, find_node(key));
+    }
+    const_iterator find(const Key &key) const {
+        return const_iterator(this, find_node(key));
+    }
+    /**
+     * returns an iterator to the first element whose key is not less than key,
+     *   or end() if no such element exists.
+     */
+    iterator lower_bound(const Key &key) {
+        return iterator(this, bound(key, false));
+    }
+    const_iterator lower_bound(const Key &key) const {
+        return const_iterator(this, bound(key, false));
+    }
+    /**
+     * returns an iterator to the first element whose key is greater than key,
+     *   or end() if no such element exists.
+     */
+    iterator upper_bound(const Key &key) {
+        return iterator(this, bound(key, true));
+    }
+    const_iterator upper_bound(const Key &key) const {
+        return const_iterator(this, bound(key, true));
+    }
+    iterator begin() {
+        return iterator(this, root == nullptr ? nullptr : minimum(root));
+    }
+    const_iterator cbegin() const {
+        return const_iterator(this, root == nullptr ? nullptr : minimum(root));
+    }
+    iterator end() {
+        return iterator(this, nullptr);
+    }
+    const_iterator cend() const {
+        return const_iterator(this, nullptr);
+    }
+    /**
+     * returns the counters of this map when compiled with SJTU_STATS, zeros otherwise.
+     * the height is computed on the spot in O(n).
+     */
+    map_stats stats() const {
+        map_stats res;
+        SJTU_STAT(res = counters;)
+        SJTU_STAT(res.height = height(root);)
+        return res;
+    }
+};
+
+template<class Key, class T, class Compare>
+void swap(rb_map<Key, T, Compare> &a, rb_map<Key, T, Compare> &b) noexcept {
+    a.swap(b);
+}
+
+}
+
+#endif
@@ -0,0 +1,446 @@
+#ifndef SJTU_ROARING_BITMAP_HPP
+#define SJTU_ROARING_BITMAP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include "exceptions.hpp"
+#include "vector.hpp"
+#include "sequential_sort.hpp"
+#include "simd_algorithm.hpp"
+
+namespace sjtu {
+/**
+ * a compressed set of uint32_t in the style of Roaring bitmaps.
+ * the values are grouped by their high 16 bits; each group with at least one value has a
+ *   container for the low 16 bits, which is either
+ *   - an array: a sorted vector<uint16_t>, for at most ARRAY_MAX values (2 bytes a value), or
+ *   - a bitmap: 1024 words covering all 65536 low halves (8 KiB, whatever the count).
+ *   a container is switched to the other kind whenever its size crosses ARRAY_MAX, so it
+ *   never takes more than 8 KiB and never more than 2 bytes per value.
+ * set operations work container by container: two bitmaps are combined with the word
+ *   kernels of simd_algorithm.hpp, two arrays are merged, and an array is checked against
+ *   a bitmap by bit tests.
+ * iterators are invalidated by add and remove.
+ */
+class roaring_bitmap {
+private:
+    static const size_t ARRAY_MAX = 4096;
+    static const size_t BITMAP_WORDS = 1024;
+    static const size_t WORD = 64;
+
+    struct container {
+        vector<uint16_t> arr;  //数组容器，升序
+        vector<uint64_t> bits; //位图容器，数组容器时为空
+        size_t card;
+
+        container() : card(0) {}
+        bool is_bitmap() const {
+            return !bits.empty();
+        }
+        bool test(uint16_t x) const {
+            return bits[x / WORD] >> (x % WORD) & 1;
+        }
+        size_t lower_bound(uint16_t x) const {
+            size_t l = 0, r = arr.size();
+            while (l < r) {
+                size_t mid = (l + r) / 2;
+                if (arr[mid] < x) l = mid + 1;
+                else r = mid;
+            }
+            return l;
+        }
+        bool contains(uint16_t x) const {
+            if (is_bitmap()) return test(x);
+            size_t i = lower_bound(x);
+            return i < arr.size() && arr[i] == x;
+        }
+        bool add(uint16_t x) {
+            if (is_bitmap()) {
+                if (test(x)) return false;
+                bits[x / WORD] |= uint64_t(1) << (x % WORD);
+            } else {
+                size_t i = lower_bound(x);
+                if (i < arr.size() && arr[i] == x) return false;
+                arr.insert(i, x);
+            }
+            ++card;
+            normalize();
+            return true;
+        }
+        bool remove(uint16_t x) {
+            if (is_bitmap()) {
+                if (!test(x)) return false;
+                bits[x / WORD] &= ~(uint64_t(1) << (x % WORD));
+            } else {
+                size_t i = lower_bound(x);
+                if (i == arr.size() || arr[i] != x) return false;
+                arr.erase(i);
+            }
+            --card;
+            normalize();
+            return true;
+        }
+        void to_bitmap() {
+            bits.resize(BITMAP_WORDS, 0);
+            for (size_t i = 0; i < arr.size();++i) bits[arr[i] / WORD] |= uint64_t(1) << (arr[i] % WORD);
+            vector<uint16_t>().swap(arr);
+        }
+        void to_array() {
+            arr.reserve(card);
+            for (size_t i = 0; i < BITMAP_WORDS;++i)
+                for (uint64_t w = bits[i]; w; w &= w - 1) arr.push_back(uint16_t(i * WORD + __builtin_ctzll(w)));
+            vector<uint64_t>().swap(bits);
+        }
+        //保证数组容器不超过ARRAY_MAX个值，位图容器超过ARRAY_MAX个值
+        void normalize() {
+            if (is_bitmap() && card <= ARRAY_MAX) to_array();
+            else if (!is_bitmap() && card > ARRAY_MAX) to_bitmap();
+        }
+        //pos之后第一个1的位置，没有则返回65536
+        size_t next_bit(size_t pos) const {
+            size_t w = pos / WORD;
+            uint64_t cur = bits[w] & (~uint64_t(1) << (pos % WORD));
+            while (!cur) {
+                if (++w == BITMAP_WORDS) return BITMAP_WORDS * WORD;
+                cur = bits[w];
+            }
+            return w * WORD + __builtin_ctzll(cur);
+        }
+        size_t memory_usage() const {
+            return arr.capacity() * sizeof(uint16_t) + bits.capacity() * sizeof(uint64_t);
+        }
+        bool operator==(const container &other) const {
+            if (card != other.card || is_bitmap() != other.is_bitmap()) return false;
+            for (size_t i = 0; i < arr.size();++i)
+                if (arr[i] != other.arr[i]) return false;
+            for (size_t i = 0; i < bits.size();++i)
+                if (bits[i] != other.bits[i]) return false;
+            return true;
+        }
+    };
+
+    vector<uint16_t> keys;
+    vector<container> cs;
+    size_t card;
+
+    //按值是否在a、b中出现决定它是否留在结果里
+    static bool keep(bool in_a, bool in_b, simd::and_op) {
+        return in_a && in_b;
+    }
+    static bool keep(bool in_a, bool in_b, simd::or_op) {
+        return in_a || in_b;
+    }
+    static bool keep(bool in_a, bool in_b, simd::xor_op) {
+        return in_a != in_b;
+    }
+    static bool keep(bool in_a, bool in_b, simd::andnot_op) {
+        return in_a && !in_b;
+    }
+    static void combine_words(uint64_t *dst, const uint64_t *src, simd::and_op) {
+        simd::bit_and(dst, src, BITMAP_WORDS);
+    }
+    static void combine_words(uint64_t *dst, const uint64_t *src, simd::or_op) {
+        simd::bit_or(dst, src, BITMAP_WORDS);
+    }
+    static void combine_words(uint64_t *dst, const uint64_t *src, simd::xor_op) {
+        simd::bit_xor(dst, src, BITMAP_WORDS);
+    }
+    static void combine_words(uint64_t *dst, const uint64_t *src, simd::andnot_op) {
+        simd::bit_andnot(dst, src, BITMAP_WORDS);
+    }
+    //数组只可能缩小的情况：逐个测试另一边的位图
+    template<class Op>
+    static container filter(const container &a, const container &b, Op op) {
+        container res;
+        for (size_t i = 0; i < a.arr.size();++i)
+            if (keep(true, b.test(a.arr[i]), op)) res.arr.push_back(a.arr[i]);
+        res.card = res.arr.size();
+        return res;
+    }
+    template<class Op>
+    static container combine(const container &a, const container &b, Op op) {
+        if (!a.is_bitmap() && !b.is_bitmap()) {
+            container res;
+            size_t i = 0, j = 0;
+            while (i < a.arr.size() || j < b.arr.size()) {
+                if (j == b.arr.size() || (i < a.arr.size() && a.arr[i] < b.arr[j])) {
+                    if (keep(true, false, op)) res.arr.push_back(a.arr[i]);
+                    ++i;
+                } else if (i == a.arr.size() || b.arr[j] < a.arr[i]) {
+                    if (keep(false, true, op)) res.arr.push_back(b.arr[j]);
+                    ++j;
+                } else {
+                    if (keep(true, true, op)) res.arr.push_back(a.arr[i]);
+                    ++i, ++j;
+                }
+            }
+            res.card = res.arr.size();
+            res.normalize();
+            return res;
+        }
+        if (!a.is_bitmap() && !keep(false, true, op)) return filter(a, b, op);
+        if (!b.is_bitmap() && keep(true, true, op) && !keep(true, false, op)) return filter(b, a, op);
+        container res(a), other;
+        if (!res.is_bitmap()) res.to_bitmap();
+        const container *pb = &b;
+        if (!b.is_bitmap()) {
+            other = b;
+            other.to_bitmap();
+            pb = &other;
+        }
+        combine_words(res.bits.data(), pb->bits.data(), op);
+        res.card = simd::popcount(res.bits.data(), BITMAP_WORDS);
+        res.normalize();
+        return res;
+    }
+    void push(uint16_t key, container &&c) {
+        if (!c.card) return;
+        card += c.card;
+        keys.push_back(key);
+        cs.push_back(static_cast<container &&>(c));
+    }
+    template<class Op>
+    static roaring_bitmap combine(const roaring_bitmap &a, const roaring_bitmap &b, Op op) {
+        roaring_bitmap res;
+        size_t i = 0, j = 0;
+        while (i < a.keys.size() || j < b.keys.size()) {
+            if (j == b.keys.size() || (i < a.keys.size() && a.keys[i] < b.keys[j])) {
+                if (keep(true, false, op)) res.push(a.keys[i], container(a.cs[i]));
+                ++i;
+            } else if (i == a.keys.size() || b.keys[j] < a.keys[i]) {
+                if (keep(false, true, op)) res.push(b.keys[j], container(b.cs[j]));
+                ++j;
+            } else {
+                res.push(a.keys[i], combine(a.cs[i], b.cs[j], op));
+                ++i, ++j;
+            }
+        }
+        return res;
+    }
+    size_t find_key(uint16_t key) const {
+        size_t l = 0, r = keys.size();
+        while (l < r) {
+            size_t mid = (l + r) / 2;
+            if (keys[mid] < key) l = mid + 1;
+            else r = mid;
+        }
+        return l;
+    }
+    //values必须升序，可以有重复
+    void build_sorted(const uint32_t *first, const uint32_t *last) {
+        while (first != last) {
+            uint16_t key = uint16_t(*first >> 16);
+            const uint32_t *group = first;
+            while (first != last && (*first >> 16) == key) ++first;
+            container c;
+            if (size_t(first - group) > ARRAY_MAX) {
+                c.bits.resize(BITMAP_WORDS, 0);
+                for (const uint32_t *p = group; p != first;++p) c.bits[(*p & 0xffff) / WORD] |= uint64_t(1) << (*p % WORD);
+                c.card = simd::popcount(c.bits.data(), BITMAP_WORDS);
+            } else {
+                for (const uint32_t *p = group; p != first;++p)
+                    if (c.arr.empty() || c.arr.back() != uint16_t(*p)) c.arr.push_back(uint16_t(*p));
+                c.card = c.arr.size();
+            }
+            c.normalize();
+            push(key, static_cast<container &&>(c));
+        }
+    }
+public:
+    class const_iterator {
+        friend class roaring_bitmap;
+    private:
+        const roaring_bitmap *bm;
+        size_t ci;  //第几个容器
+        size_t pos; //数组容器里的下标，或位图容器里的位
+        const_iterator(const roaring_bitmap *bm, size_t ci, size_t pos) : bm(bm), ci(ci), pos(pos) {}
+        //落在一个位图容器上时移到它的第一个1
+        void settle() {
+            if (ci < bm->cs.size() && bm->cs[ci].is_bitmap() && !bm->cs[ci].test(uint16_t(pos)))
+                pos = bm->cs[ci].next_bit(pos);
+        }
+    public:
+        const_iterator() : bm(nullptr), ci(0), pos(0) {}
+        uint32_t operator*() const {
+            if (!bm || ci >= bm->cs.size()) throw invalid_iterator();
+            const container &c = bm->cs[ci];
+            return uint32_t(bm->keys[ci]) << 16 | (c.is_bitmap() ? uint32_t(pos) : uint32_t(c.arr[pos]));
+        }
+        const_iterator &operator++() {
+            if (!bm || ci >= bm->cs.size()) throw invalid_iterator();
+            const container &c = bm->cs[ci];
+            size_t limit = c.is_bitmap() ? BITMAP_WORDS * WORD : c.arr.size();
+            pos = c.is_bitmap() ? c.next_bit(pos) : pos + 1;
+            if (pos == limit) {
+                ++ci, pos = 0;
+                settle();
+            }
+            return *this;
+        }
+        const_iterator operator++(int) {
+            const_iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+        bool operator==(const const_iterator &rhs) const {
+            return bm == rhs.bm && ci == rhs.ci && pos == rhs.pos;
+        }
+        bool operator!=(const const_iterator &rhs) const {
+            return !(*this == rhs);
+        }
+    };
+
+    roaring_bitmap() : card(0) {}
+    /**
+     * the set of the values in v, which may be unsorted and contain duplicates.
+     */
+    explicit roaring_bitmap(const vector<uint32_t> &v) : card(0) {
+        bool sorted = true;
+        for (size_t i = 1; i < v.size() && sorted;++i) sorted = !(v[i] < v[i - 1]);
+        if (sorted) {
+            build_sorted(v.data(), v.data() + v.size());
+        } else {
+            vector<uint32_t> tmp(v);
+            radix_sort(tmp.data(), tmp.data() + tmp.size());
+            build_sorted(tmp.data(), tmp.data() + tmp.size());
+        }
+    }
+
+    size_t size() const {
+        return card;
+    }
+    bool empty() const {
+        return card == 0;
+    }
+    void clear() {
+        keys.clear();
+        cs.clear();
+        card = 0;
+    }
+    bool contains(uint32_t x) const {
+        size_t i = find_key(uint16_t(x >> 16));
+        return i < keys.size() && keys[i] == uint16_t(x >> 16) && cs[i].contains(uint16_t(x));
+    }
+    /**
+     * inserts x, returns false if it was already there.
+     */
+    bool add(uint32_t x) {
+        uint16_t key = uint16_t(x >> 16);
+        size_t i = find_key(key);
+        if (i == keys.size() || keys[i] != key) {
+            keys.insert(i, key);
+            cs.insert(i, container());
+        }
+        if (!cs[i].add(uint16_t(x))) return false;
+        ++card;
+        return true;
+    }
+    /**
+     * erases x, returns false if it was not there.
+     */
+    bool remove(uint32_t x) {
+        uint16_t key = uint16_t(x >> 16);
+        size_t i = find_key(key);
+        if (i == keys.size() || keys[i] != key || !cs[i].remove(uint16_t(x))) return false;
+        if (!cs[i].card) {
+            keys.erase(i);
+            cs.erase(i);
+        }
+        --card;
+        return true;
+    }
+
+    friend roaring_bitmap operator&(const roaring_bitmap &a, const roaring_bitmap &b) {
+        return combine(a, b, simd::and_op());
+    }
+    friend roaring_bitmap operator|(const roaring_bitmap &a, const roaring_bitmap &b) {
+        return combine(a, b, simd::or_op());
+    }
+    friend roaring_bitmap operator^(const roaring_bitmap &a, const roaring_bitmap &b) {
+        return combine(a, b, simd::xor_op());
+    }
+    /**
+     * the values of a that are not in b.
+     */
+    friend roaring_bitmap operator-(const roaring_bitmap &a, const roaring_bitmap &b) {
+        return combine(a, b, simd::andnot_op());
+    }
+    roaring_bitmap &operator&=(const roaring_bitmap &other) {
+        return *this = *this & other;
+    }
+    roaring_bitmap &operator|=(const roaring_bitmap &other) {
+        return *this = *this | other;
+    }
+    roaring_bitmap &operator^=(const roaring_bitmap &other) {
+        return *this = *this ^ other;
+    }
+    roaring_bitmap &operator-=(const roaring_bitmap &other) {
+        return *this = *this - other;
+    }
+    bool operator==(const roaring_bitmap &other) const {
+        if (card != other.card || keys.size() != other.keys.size()) return false;
+        for (size_t i = 0; i < keys.size();++i)
+            if (keys[i] != other.keys[i] || !(cs[i] == other.cs[i])) return false;
+        return true;
+    }
+    bool operator!=(const roaring_bitmap &other) const {
+        return !(*this == other);
+    }
+
+    const_iterator begin() const {
+        const_iterator it(this, 0, 0);
+        it.settle();
+        return it;
+    }
+    const_iterator end() const {
+        return const_iterator(this, cs.size(), 0);
+    }
+    /**
+     * calls f(x) for every value in increasing order.
+     */
+    template<class F>
+    void for_each(F f) const {
+        for (size_t i = 0; i < cs.size();++i) {
+            uint32_t high = uint32_t(keys[i]) << 16;
+            const container &c = cs[i];
+            if (c.is_bitmap()) {
+                for (size_t w = 0; w < BITMAP_WORDS;++w)
+                    for (uint64_t x = c.bits[w]; x; x &= x - 1) f(high | uint32_t(w * WORD + __builtin_ctzll(x)));
+            } else {
+                for (size_t j = 0; j < c.arr.size();++j) f(high | c.arr[j]);
+            }
+        }
+    }
+    /**
+     * the values in increasing order.
+     */
+    vector<uint32_t> to_vector() const {
+        vector<uint32_t> res;
+        res.reserve(card);
+        for (size_t i = 0; i < cs.size();++i) {
+            uint32_t high = uint32_t(keys[i]) << 16;
+            const container &c = cs[i];
+            if (c.is_bitmap()) {
+                for (size_t w = 0; w < BITMAP_WORDS;++w)
+                    for (uint64_t x = c.bits[w]; x; x &= x - 1) res.push_back(high | uint32_t(w * WORD + __builtin_ctzll(x)));
+            } else {
+                for (size_t j = 0; j < c.arr.size();++j) res.push_back(high | c.arr[j]);
+            }
+        }
+        return res;
+    }
+    size_t memory_usage() const {
+        size_t res = sizeof(*this) + keys.capacity() * sizeof(uint16_t) + cs.capacity() * sizeof(container);
+        for (size_t i = 0; i < cs.size();++i) res += cs[i].memory_usage();
+        return res;
+    }
+    void swap(roaring_bitmap &other) {
+        keys.swap(other.keys);
+        cs.swap(other.cs);
+        size_t t = card; card = other.card; other.card = t;
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,220 @@
+#ifndef SJTU_SEQUENTIAL_SORT_HPP
+#define SJTU_SEQUENTIAL_SORT_HPP
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace sjtu {
+/**
+ * the single-threaded sorting routines over contiguous ranges [first, last):
+ *   intro_sort     quicksort falling back to heapsort, insertion sort on short ranges; not stable
+ *   merge_sort     stable, O(n) extra memory
+ *   radix_sort     LSD radix sort for integer keys, stable, O(n) extra memory
+ * this header has no dependencies, containers such as list include it to sort themselves.
+ * sort.hpp adds the overloads for sjtu::vector and parallel_sort.
+ */
+namespace sort_detail {
+    //短区间直接插入排序，稳定
+    const ptrdiff_t INSERTION_CUTOFF = 16;
+
+    template<class T, class Compare>
+    void insertion_sort(T *first, T *last, Compare &cmp) {
+        if (first == last) return;
+        for (T *i = first + 1; i < last;++i) {
+            if (!cmp(*i, *(i - 1))) continue;
+            T tmp(std::move(*i));
+            T *j = i;
+            do {
+                *j = std::move(*(j - 1));
+                --j;
+            } while (j > first && cmp(tmp, *(j - 1)));
+            *j = std::move(tmp);
+        }
+    }
+
+    template<class T, class Compare>
+    void sift_down(T *a, ptrdiff_t i, ptrdiff_t n, Compare &cmp) {
+        T tmp(std::move(a[i]));
+        while (2 * i + 1 < n) {
+            ptrdiff_t c = 2 * i + 1;
+            if (c + 1 < n && cmp(a[c], a[c + 1])) ++c;
+            if (!cmp(tmp, a[c])) break;
+            a[i] = std::move(a[c]);
+            i = c;
+        }
+        a[i] = std::move(tmp);
+    }
+
+    template<class T, class Compare>
+    void heap_sort(T *first, T *last, Compare &cmp) {
+        ptrdiff_t n = last - first;
+        for (ptrdiff_t i = n / 2 - 1; i >= 0;--i) sift_down(first, i, n, cmp);
+        for (ptrdiff_t i = n - 1; i > 0;--i) {
+            std::swap(first[0], first[i]);
+            sift_down(first, 0, i, cmp);
+        }
+    }
+
+    //三数取中放到first上作为枢轴
+    template<class T, class Compare>
+    void median_to_first(T *first, T *mid, T *last, Compare &cmp) {
+        T *a = first + 1;
+        if (cmp(*a, *mid)) {
+            if (cmp(*mid, *last)) std::swap(*first, *mid);
+            else if (cmp(*a, *last)) std::swap(*first, *last);
+            else std::swap(*first, *a);
+        }
+        else {
+            if (cmp(*a, *last)) std::swap(*first, *a);
+            else if (cmp(*mid, *last)) std::swap(*first, *last);
+            else std::swap(*first, *mid);
+        }
+    }
+
+    template<class T, class Compare>
+    void intro_sort(T *first, T *last, int depth, Compare &cmp) {
+        while (last - first > INSERTION_CUTOFF) {
+            if (depth == 0) {
+                heap_sort(first, last, cmp);
+                return;
+            }
+            --depth;
+            median_to_first(first, first + (last - first) / 2, last - 1, cmp);
+            //Hoare划分，枢轴在first上
+            T *l = first + 1, *r = last;
+            while (true) {
+                while (cmp(*l, *first)) ++l;
+                --r;
+                while (cmp(*first, *r)) --r;
+                if (l >= r) break;
+                std::swap(*l, *r);
+                ++l;
+            }
+            //较小的一半递归，较大的一半循环，栈深度O(logn)
+            if (l - first < last - l) {
+                intro_sort(first, l, depth, cmp);
+                first = l;
+            }
+            else {
+                intro_sort(l, last, depth, cmp);
+                last = l;
+            }
+        }
+        insertion_sort(first, last, cmp);
+    }
+
+    //buf为至少(last - first) / 2个元素的未构造空间
+    template<class T, class Compare>
+    void merge_sort(T *first, T *last, T *buf, Compare &cmp) {
+        ptrdiff_t n = last - first;
+        if (n <= INSERTION_CUTOFF) {
+            insertion_sort(first, last, cmp);
+            return;
+        }
+        T *mid = first + n / 2;
+        merge_sort(first, mid, buf, cmp);
+        merge_sort(mid, last, buf, cmp);
+        if (!cmp(*mid, *(mid - 1))) return;
+        //左半段搬到buf，再和右半段归并回来
+        ptrdiff_t m = mid - first;
+        for (ptrdiff_t i = 0; i < m;++i) new (buf + i) T(std::move(first[i]));
+        T *i = buf, *j = mid, *k = first;
+        while (i < buf + m && j < last) {
+            if (cmp(*j, *i)) *k++ = std::move(*j++);
+            else *k++ = std::move(*i++);
+        }
+        while (i < buf + m) *k++ = std::move(*i++);
+        for (ptrdiff_t t = 0; t < m;++t) buf[t].~T();
+    }
+
+    //整数映射成保持大小顺序的无符号数：有符号数翻转符号位
+    template<class K>
+    typename std::make_unsigned<K>::type radix_key(K k) {
+        typedef typename std::make_unsigned<K>::type U;
+        if (std::is_signed<K>::value) return U(k) ^ (U(1) << (sizeof(U) * 8 - 1));
+        return U(k);
+    }
+
+    template<class T>
+    struct identity {
+        const T &operator()(const T &x) const {
+            return x;
+        }
+    };
+}
+
+/**
+ * sort [first, last) with cmp, not stable.
+ * O(nlogn) in the worst case: quicksort with median-of-three pivots,
+ *   switching to heapsort when the recursion gets too deep, and insertion sort on short ranges.
+ */
+template<class T, class Compare = std::less<T>>
+void intro_sort(T *first, T *last, Compare cmp = Compare()) {
+    if (last - first < 2) return;
+    int depth = 0;
+    for (ptrdiff_t n = last - first; n > 1; n >>= 1) depth += 2;
+    sort_detail::intro_sort(first, last, depth, cmp);
+}
+
+/**
+ * sort [first, last) with cmp, equivalent elements keep their relative order.
+ */
+template<class T, class Compare = std::less<T>>
+void merge_sort(T *first, T *last, Compare cmp = Compare()) {
+    ptrdiff_t n = last - first;
+    if (n < 2) return;
+    T *buf = (T *)malloc((n / 2 + 1) * sizeof(T));
+    sort_detail::merge_sort(first, last, buf, cmp);
+    free(buf);
+}
+
+/**
+ * sort [first, last) by the integer key(x) in ascending order, stable.
+ * one counting pass per byte of the key, passes in which all keys share the byte are skipped.
+ * T must be trivially copyable.
+ */
+template<class T, class KeyOf>
+void radix_sort(T *first, T *last, KeyOf key) {
+    static_assert(std::is_trivially_copyable<T>::value, "radix_sort moves elements bytewise");
+    typedef typename std::decay<decltype(key(*first))>::type K;
+    static_assert(std::is_integral<K>::value, "radix_sort needs an integer key");
+    size_t n = last - first;
+    if (n < 2) return;
+    T *buf = (T *)malloc(n * sizeof(T));
+    T *src = first, *dst = buf;
+    size_t cnt[256];
+    for (size_t shift = 0; shift < sizeof(K) * 8; shift += 8) {
+        memset(cnt, 0, sizeof(cnt));
+        for (size_t i = 0; i < n;++i) ++cnt[(sort_detail::radix_key(key(src[i])) >> shift) & 255];
+        //这一位全都相同就不用搬
+        if (cnt[(sort_detail::radix_key(key(src[0])) >> shift) & 255] == n) continue;
+        size_t sum = 0;
+        for (size_t d = 0; d < 256;++d) {
+            size_t c = cnt[d];
+            cnt[d] = sum;
+            sum += c;
+        }
+        for (size_t i = 0; i < n;++i) {
+            size_t d = (sort_detail::radix_key(key(src[i])) >> shift) & 255;
+            memcpy(dst + cnt[d]++, src + i, sizeof(T));
+        }
+        T *tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+    if (src != first) memcpy(first, src, n * sizeof(T));
+    free(buf);
+}
+template<class T>
+void radix_sort(T *first, T *last) {
+    radix_sort(first, last, sort_detail::identity<T>());
+}
+
+}
+
+#endif
@@ -0,0 +1,663 @@
+#ifndef SJTU_SERIALIZE_HPP
+#define SJTU_SERIALIZE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <istream>
+#include <new>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include "exceptions.hpp"
+#include "utility.hpp"
+#include "vector.hpp"
+#include "list.hpp"
+#include "map.hpp"
+#include "linked_hashmap.hpp"
+#include "priority_queue.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SJTU_SERIALIZE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace sjtu {
+/**
+ * binary snapshots of the containers.
+ *
+ * save(os, c) / load(is, c) stream a container in the format
+ *   header (magic, format version, container tag, sizeof(element), element count)
+ *   followed by the elements, each written by serializer<element>.
+ * load replaces the contents of c and throws runtime_error on a truncated stream or a header
+ *   which does not match the container. the element count in the header is not trusted:
+ *   at most 1 MiB is allocated ahead of the data actually read. maps are rebuilt in O(n) through insert_sorted since
+ *   they are saved in key order, linked_hashmaps keep their insertion order.
+ *
+ * save_frozen(c, path) writes a map or linked_hashmap whose key and mapped types are trivially
+ *   copyable in a layout that frozen_map_view / frozen_hashmap_view query directly from the
+ *   mmap'ed file, so opening one costs nothing beyond the page faults of the lookups.
+ *
+ * snapshots use the byte order and type layout of the machine that wrote them.
+ */
+template<class T, class Enable = void>
+class serializer;
+
+namespace serialize_detail {
+    //文件头里的"SJTU"
+    const uint32_t MAGIC = 0x55544a53;
+    const uint32_t VERSION = 1;
+    enum container_tag : uint32_t {
+        TAG_VECTOR = 1,
+        TAG_LIST,
+        TAG_MAP,
+        TAG_HASHMAP,
+        TAG_PRIORITY_QUEUE,
+        TAG_FROZEN_MAP,
+        TAG_FROZEN_HASHMAP
+    };
+    //frozen文件中各段按此对齐
+    const size_t ALIGN = 64;
+
+    inline void write_bytes(std::ostream &os, const void *p, size_t n) {
+        os.write(static_cast<const char *>(p), n);
+        if (!os) throw runtime_error();
+    }
+    inline void read_bytes(std::istream &is, void *p, size_t n) {
+        is.read(static_cast<char *>(p), n);
+        if (size_t(is.gcount()) != n) throw runtime_error();
+    }
+
+    class header {
+    public:
+        uint32_t magic, version, tag, elem_size;
+        uint64_t count;
+    };
+    inline void write_header(std::ostream &os, uint32_t tag, size_t elem_size, size_t count) {
+        header h = {MAGIC, VERSION, tag, uint32_t(elem_size), count};
+        write_bytes(os, &h, sizeof(h));
+    }
+    //返回元素个数，文件头不对时抛runtime_error
+    inline size_t read_header(std::istream &is, uint32_t tag, size_t elem_size) {
+        header h;
+        read_bytes(is, &h, sizeof(h));
+        if (h.magic != MAGIC || h.version != VERSION || h.tag != tag || h.elem_size != elem_size)
+            throw runtime_error();
+        return h.count;
+    }
+
+    //逐个从流里读出元素的输入迭代器，供map::insert_sorted使用
+    template<class T>
+    class stream_reader {
+    private:
+        std::istream &is;
+        size_t left;
+        alignas(T) unsigned char buf[sizeof(T)];
+        bool has;
+    public:
+        stream_reader(std::istream &_is, size_t n) : is(_is), left(n), has(false) {
+            next();
+        }
+        ~stream_reader() {
+            if (has) current().~T();
+        }
+        T &current() {
+            return *reinterpret_cast<T *>(buf);
+        }
+        bool done() const {
+            return !has;
+        }
+        void next() {
+            if (has) current().~T();
+            has = false;
+            if (left == 0) return;
+            new (buf) T(serializer<T>::load(is));
+            has = true;
+            --left;
+        }
+    };
+    template<class T>
+    class load_iterator {
+    private:
+        stream_reader<T> *r;
+    public:
+        explicit load_iterator(stream_reader<T> *_r = nullptr) : r(_r) {}
+        T &operator*() const {
+            return r->current();
+        }
+        load_iterator &operator++() {
+            r->next();
+            return *this;
+        }
+        bool operator==(const load_iterator &rhs) const {
+            return (!r || r->done()) == (!rhs.r || rhs.r->done());
+        }
+        bool operator!=(const load_iterator &rhs) const {
+            return !(*this == rhs);
+        }
+    };
+
+    inline size_t align_up(size_t x) {
+        return (x + ALIGN - 1) / ALIGN * ALIGN;
+    }
+    //frozen文件的头，之后各段都从ALIGN的倍数处开始
+    //seed是带密钥的Hash（seeded_hash）的密钥，其他Hash为0
+    class frozen_header {
+    public:
+        uint32_t magic, version, tag, key_size, value_size, reserved;
+        uint64_t count, slots;
+        uint64_t seed[2];
+    };
+    //count个size字节的元素能否放进limit字节，乘法不会溢出
+    inline bool fits(uint64_t count, size_t size, size_t limit) {
+        return count <= limit / size;
+    }
+    //文件头里的个数不可信，照它预先分配时最多分配这么多字节，再多的边读边长
+    const size_t PREALLOC_BYTES = 1 << 20;
+    inline size_t prealloc(uint64_t count, size_t size) {
+        return fits(count, size, PREALLOC_BYTES) ? size_t(count) : PREALLOC_BYTES / size + 1;
+    }
+    template<class Hash>
+    void get_seed(const Hash &hash, uint64_t *seed, std::true_type) {
+        hash.get_key(seed[0], seed[1]);
+    }
+    template<class Hash>
+    void get_seed(const Hash &, uint64_t *seed, std::false_type) {
+        seed[0] = seed[1] = 0;
+    }
+    template<class Hash>
+    Hash make_hash(const uint64_t *seed, std::true_type) {
+        return Hash(seed[0], seed[1]);
+    }
+    template<class Hash>
+    Hash make_hash(const uint64_t *, std::false_type) {
+        return Hash();
+    }
+    inline void write_padding(std::ostream &os, size_t n) {
+        static const char zeros[ALIGN] = {};
+        write_bytes(os, zeros, n);
+    }
+
+    //开放定址表的散列值再打散一次，std::hash对整数是恒等映射
+    inline uint64_t mix(uint64_t h) {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+}
+
+/**
+ * how a T is written to and read from a stream; specialize it for your own types.
+ * a specialization provides
+ *   static const bool bitwise;   true only if T can be copied with memcpy as a whole array
+ *   static void save(std::ostream &os, const T &x);
+ *   static T load(std::istream &is);
+ * the primary template handles trivially copyable types bytewise.
+ */
+template<class T, class Enable>
+class serializer {
+    static_assert(std::is_trivially_copyable<T>::value, "specialize sjtu::serializer for this type");
+public:
+    static const bool bitwise = true;
+    static void save(std::ostream &os, const T &x) {
+        serialize_detail::write_bytes(os, &x, sizeof(T));
+    }
+    static T load(std::istream &is) {
+        T x;
+        serialize_detail::read_bytes(is, &x, sizeof(T));
+        return x;
+    }
+};
+
+template<>
+class serializer<std::string> {
+public:
+    static const bool bitwise = false;
+    static void save(std::ostream &os, const std::string &x) {
+        uint64_t n = x.size();
+        serialize_detail::write_bytes(os, &n, sizeof(n));
+        serialize_detail::write_bytes(os, x.data(), n);
+    }
+    static std::string load(std::istream &is) {
+        uint64_t n;
+        serialize_detail::read_bytes(is, &n, sizeof(n));
+        //按块读，截断的流读到末尾就失败，不会先照n分配
+        std::string x;
+        size_t chunk = serialize_detail::prealloc(n, 1);
+        for (uint64_t done = 0; done < n;) {
+            size_t k = n - done < chunk ? size_t(n - done) : chunk;
+            x.resize(size_t(done) + k);
+            serialize_detail::read_bytes(is, &x[size_t(done)], k);
+            done += k;
+        }
+        return x;
+    }
+};
+
+template<class T1, class T2>
+class serializer<pair<T1, T2>> {
+    typedef typename std::remove_const<T1>::type first_type;
+    typedef typename std::remove_const<T2>::type second_type;
+public:
+    static const bool bitwise = false;
+    static void save(std::ostream &os, const pair<T1, T2> &x) {
+        serializer<first_type>::save(os, x.first);
+        serializer<second_type>::save(os, x.second);
+    }
+    static pair<T1, T2> load(std::istream &is) {
+        //先后顺序要固定，不能直接写在构造函数的参数里
+        first_type a = serializer<first_type>::load(is);
+        second_type b = serializer<second_type>::load(is);
+        return pair<T1, T2>(std::move(a), std::move(b));
+    }
+};
+
+template<class T>
+void save(std::ostream &os, const vector<T> &v) {
+    serialize_detail::write_header(os, serialize_detail::TAG_VECTOR, sizeof(T), v.size());
+    if (serializer<T>::bitwise) serialize_detail::write_bytes(os, v.data(), v.size() * sizeof(T));
+    else {
+        for (size_t i = 0; i < v.size();++i) serializer<T>::save(os, v[i]);
+    }
+}
+template<class T>
+void load(std::istream &is, vector<T> &v) {
+    size_t n = serialize_detail::read_header(is, serialize_detail::TAG_VECTOR, sizeof(T));
+    if (!serialize_detail::fits(n, sizeof(T), size_t(-1))) throw runtime_error();
+    v.clear();
+    if (serializer<T>::bitwise) {
+        //按块读，截断的流读到末尾就失败，不会先照n分配
+        size_t chunk = serialize_detail::prealloc(n, sizeof(T));
+        for (size_t done = 0; done < n;) {
+            size_t k = n - done < chunk ? n - done : chunk;
+            v.resize(done + k);
+            serialize_detail::read_bytes(is, v.data() + done, k * sizeof(T));
+            done += k;
+        }
+    }
+    else {
+        v.reserve(serialize_detail::prealloc(n, sizeof(T)));
+        for (size_t i = 0; i < n;++i) v.push_back(serializer<T>::load(is));
+    }
+}
+
+template<class T>
+void save(std::ostream &os, const list<T> &l) {
+    serialize_detail::write_header(os, serialize_detail::TAG_LIST, sizeof(T), l.size());
+    for (typename list<T>::const_iterator it = l.cbegin(); it != l.cend();++it) serializer<T>::save(os, *it);
+}
+template<class T>
+void load(std::istream &is, list<T> &l) {
+    size_t n = serialize_detail::read_header(is, serialize_detail::TAG_LIST, sizeof(T));
+    l.clear();
+    for (size_t i = 0; i < n;++i) l.push_back(serializer<T>::load(is));
+}
+
+template<class Key, class T, class Compare>
+void save(std::ostream &os, const map<Key, T, Compare> &m) {
+    typedef typename map<Key, T, Compare>::value_type value_type;
+    serialize_detail::write_header(os, serialize_detail::TAG_MAP, sizeof(value_type), m.size());
+    for (typename map<Key, T, Compare>::const_iterator it = m.cbegin(); it != m.cend();++it)
+        serializer<value_type>::save(os, *it);
+}
+template<class Key, class T, class Compare>
+void load(std::istream &is, map<Key, T, Compare> &m) {
+    typedef typename map<Key, T, Compare>::value_type value_type;
+    size_t n = serialize_detail::read_header(is, serialize_detail::TAG_MAP, sizeof(value_type));
+    m.clear();
+    serialize_detail::stream_reader<value_type> reader(is, n);
+    m.insert_sorted(serialize_detail::load_iterator<value_type>(&reader),
+                    serialize_detail::load_iterator<value_type>());
+}
+
+template<class Key, class T, class Hash, class Equal>
+void save(std::ostream &os, const linked_hashmap<Key, T, Hash, Equal> &m) {
+    typedef typename linked_hashmap<Key, T, Hash, Equal>::value_type value_type;
+    serialize_detail::write_header(os, serialize_detail::TAG_HASHMAP, sizeof(value_type), m.size());
+    for (typename linked_hashmap<Key, T, Hash, Equal>::const_iterator it = m.cbegin(); it != m.cend();++it)
+        serializer<value_type>::save(os, *it);
+}
+template<class Key, class T, class Hash, class Equal>
+void load(std::istream &is, linked_hashmap<Key, T, Hash, Equal> &m) {
+    typedef typename linked_hashmap<Key, T, Hash, Equal>::value_type value_type;
+    size_t n = serialize_detail::read_header(is, serialize_detail::TAG_HASHMAP, sizeof(value_type));
+    m.clear();
+    m.reserve(serialize_detail::prealloc(n, sizeof(value_type)));
+    for (size_t i = 0; i < n;++i) m.insert(serializer<value_type>::load(is));
+}
+
+/**
+ * priority_queues are saved from the top down, which needs a copy of the queue.
+ */
+template<class T, class Compare>
+void save(std::ostream &os, const priority_queue<T, Compare> &q) {
+    serialize_detail::write_header(os, serialize_detail::TAG_PRIORITY_QUEUE, sizeof(T), q.size());
+    if (q.empty()) return;
+    priority_queue<T, Compare> tmp(q);
+    while (!tmp.empty()) {
+        serializer<T>::save(os, tmp.top());
+        tmp.pop();
+    }
+}
+template<class T, class Compare>
+void load(std::istream &is, priority_queue<T, Compare> &q) {
+    size_t n = serialize_detail::read_header(is, serialize_detail::TAG_PRIORITY_QUEUE, sizeof(T));
+    priority_queue<T, Compare> tmp;
+    for (size_t i = 0; i < n;++i) tmp.push(serializer<T>::load(is));
+    q = std::move(tmp);
+}
+
+/**
+ * a read-only memory mapping of a whole file.
+ * throw runtime_error if the file cannot be mapped or the platform has no mmap.
+ */
+class mapped_file {
+private:
+    const unsigned char *addr;
+    size_t len;
+    void release() {
+#ifdef SJTU_SERIALIZE_MMAP
+        if (len) munmap(const_cast<unsigned char *>(addr), len);
+#endif
+        addr = nullptr;
+        len = 0;
+    }
+public:
+    mapped_file() : addr(nullptr), len(0) {}
+    explicit mapped_file(const char *path) : addr(nullptr), len(0) {
+#ifdef SJTU_SERIALIZE_MMAP
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) throw runtime_error();
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            ::close(fd);
+            throw runtime_error();
+        }
+        void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) throw runtime_error();
+        addr = static_cast<const unsigned char *>(p);
+        len = st.st_size;
+#else
+        (void)path;
+        throw runtime_error();
+#endif
+    }
+    mapped_file(const mapped_file &) = delete;
+    mapped_file &operator=(const mapped_file &) = delete;
+    mapped_file(mapped_file &&other) noexcept : addr(other.addr), len(other.len) {
+        other.addr = nullptr;
+        other.len = 0;
+    }
+    mapped_file &operator=(mapped_file &&other) noexcept {
+        if (this == &other) return *this;
+        release();
+        std::swap(addr, other.addr);
+        std::swap(len, other.len);
+        return *this;
+    }
+    ~mapped_file() {
+        release();
+    }
+    const unsigned char *data() const {
+        return addr;
+    }
+    size_t size() const {
+        return len;
+    }
+};
+
+namespace serialize_detail {
+    //检查frozen文件头和长度，返回文件头
+    inline const frozen_header &check_frozen(const mapped_file &file, uint32_t tag,
+                                             size_t key_size, size_t value_size) {
+        if (file.size() < ALIGN) throw runtime_error();
+        const frozen_header &h = *reinterpret_cast<const frozen_header *>(file.data());
+        if (h.magic != MAGIC || h.version != VERSION || h.tag != tag ||
+            h.key_size != key_size || h.value_size != value_size)
+            throw runtime_error();
+        return h;
+    }
+}
+
+/**
+ * write m in the layout read by frozen_map_view: after the header, the keys in ascending
+ *   order as one array and the mapped values as another.
+ */
+template<class Key, class T, class Compare>
+void save_frozen(const map<Key, T, Compare> &m, const char *path) {
+    static_assert(std::is_trivially_copyable<Key>::value && std::is_trivially_copyable<T>::value,
+                  "frozen files hold trivially copyable keys and values only");
+    using namespace serialize_detail;
+    std::ofstream os(path, std::ios::binary | std::ios::trunc);
+    if (!os) throw runtime_error();
+    size_t n = m.size();
+    frozen_header h = {MAGIC, VERSION, TAG_FROZEN_MAP, sizeof(Key), sizeof(T), 0, n, n, {0, 0}};
+    write_bytes(os, &h, sizeof(h));
+    write_padding(os, ALIGN - sizeof(h));
+    typedef typename map<Key, T, Compare>::const_iterator const_iterator;
+    for (const_iterator it = m.cbegin(); it != m.cend();++it) write_bytes(os, &it->first, sizeof(Key));
+    write_padding(os, align_up(n * sizeof(Key)) - n * sizeof(Key));
+    for (const_iterator it = m.cbegin(); it != m.cend();++it) write_bytes(os, &it->second, sizeof(T));
+    os.flush();
+    if (!os) throw runtime_error();
+}
+
+/**
+ * a read-only map over a file written by save_frozen, queried in place.
+ * lookups are a branchless binary search over the key array, O(logn);
+ *   the i-th smallest element is key(i) / value(i).
+ * Compare must be the comparison the map was saved with.
+ */
+template<class Key, class T, class Compare = std::less<Key>>
+class frozen_map_view {
+    static_assert(std::is_trivially_copyable<Key>::value && std::is_trivially_copyable<T>::value,
+                  "frozen files hold trivially copyable keys and values only");
+private:
+    mapped_file file;
+    const Key *keys;
+    const T *values;
+    size_t n;
+public:
+    /**
+     * map the file at path.
+     * throw runtime_error if it cannot be mapped or was not written by save_frozen for these types.
+     */
+    explicit frozen_map_view(const char *path) : file(path) {
+        using namespace serialize_detail;
+        //keys和values两段都要放得下，先比较个数再做乘法，以免溢出
+        const frozen_header &h = check_frozen(file, TAG_FROZEN_MAP, sizeof(Key), sizeof(T));
+        size_t avail = file.size() - ALIGN;
+        if (!fits(h.count, sizeof(Key), avail)) throw runtime_error();
+        n = h.count;
+        size_t keys_bytes = align_up(n * sizeof(Key));
+        if (keys_bytes > avail || !fits(n, sizeof(T), avail - keys_bytes)) throw runtime_error();
+        keys = reinterpret_cast<const Key *>(file.data() + ALIGN);
+        values = reinterpret_cast<const T *>(file.data() + ALIGN + keys_bytes);
+    }
+    size_t size() const {
+        return n;
+    }
+    bool empty() const {
+        return n == 0;
+    }
+    /**
+     * returns the index of the first key not less than key, size() if there is none.
+     */
+    size_t lower_bound(const Key &key) const {
+        if (n == 0) return 0;
+        Compare cmp;
+        const Key *base = keys;
+        size_t len = n;
+        //每轮只有一次比较和一次条件赋值，编译成cmov，没有分支预测失败
+        while (len > 1) {
+            size_t half = len / 2;
+            base = cmp(base[half], key) ? base + half : base;
+            len -= half;
+        }
+        return (base - keys) + cmp(*base, key);
+    }
+    /**
+     * returns a pointer to the mapped value of key, nullptr if key does not exist.
+     */
+    const T *find(const Key &key) const {
+        size_t i = lower_bound(key);
+        if (i == n || Compare()(key, keys[i])) return nullptr;
+        return values + i;
+    }
+    size_t count(const Key &key) const {
+        return find(key) ? 1 : 0;
+    }
+    /**
+     * throw index_out_of_bound if key does not exist.
+     */
+    const T &at(const Key &key) const {
+        const T *p = find(key);
+        if (!p) throw index_out_of_bound();
+        return *p;
+    }
+    /**
+     * the i-th smallest key and its mapped value.
+     * throw index_out_of_bound if i >= size().
+     */
+    const Key &key(size_t i) const {
+        if (i >= n) throw index_out_of_bound();
+        return keys[i];
+    }
+    const T &value(size_t i) const {
+        if (i >= n) throw index_out_of_bound();
+        return values[i];
+    }
+};
+
+/**
+ * write m in the layout read by frozen_hashmap_view: an open addressing table with linear
+ *   probing and at most half of the slots in use, stored as an occupancy byte array,
+ *   a key array and a value array.
+ * the slots are chosen with the Hash of m, so the file can only be read with the same Hash.
+ *   the key of a keyed Hash (is_keyed_hash, e.g. seeded_hash) is stored in the header and
+ *   reused by the reader; any other Hash must hash the same in every default constructed
+ *   object, and a Hash with reseed() but no get_key() is rejected.
+ */
+template<class Key, class T, class Hash, class Equal>
+void save_frozen(const linked_hashmap<Key, T, Hash, Equal> &m, const char *path) {
+    static_assert(std::is_trivially_copyable<Key>::value && std::is_trivially_copyable<T>::value,
+                  "frozen files hold trivially copyable keys and values only");
+    static_assert(is_keyed_hash<Hash>::value || !is_reseedable<Hash>::value,
+                  "a randomly seeded Hash needs get_key() to be saved");
+    using namespace serialize_detail;
+    size_t n = m.size(), slots = 16;
+    while (slots < 2 * n) slots <<= 1;
+    vector<unsigned char> used;
+    used.assign(slots, 0);
+    vector<Key> keys;
+    keys.assign(slots, Key());
+    vector<T> values;
+    values.assign(slots, T());
+    Hash hash = m.hash_function();
+    for (typename linked_hashmap<Key, T, Hash, Equal>::const_iterator it = m.cbegin(); it != m.cend();++it) {
+        size_t i = mix(hash(it->first)) & (slots - 1);
+        while (used[i]) i = (i + 1) & (slots - 1);
+        used[i] = 1;
+        keys[i] = it->first;
+        values[i] = it->second;
+    }
+    std::ofstream os(path, std::ios::binary | std::ios::trunc);
+    if (!os) throw runtime_error();
+    frozen_header h = {MAGIC, VERSION, TAG_FROZEN_HASHMAP, sizeof(Key), sizeof(T), 0, n, slots, {0, 0}};
+    get_seed(hash, h.seed, is_keyed_hash<Hash>());
+    write_bytes(os, &h, sizeof(h));
+    write_padding(os, ALIGN - sizeof(h));
+    write_bytes(os, used.data(), slots);
+    write_padding(os, align_up(slots) - slots);
+    write_bytes(os, keys.data(), slots * sizeof(Key));
+    write_padding(os, align_up(slots * sizeof(Key)) - slots * sizeof(Key));
+    write_bytes(os, values.data(), slots * sizeof(T));
+    os.flush();
+    if (!os) throw runtime_error();
+}
+
+/**
+ * a read-only hashmap over a file written by save_frozen, queried in place in O(1) expected.
+ * Hash and Equal must be the types the linked_hashmap was saved with; a keyed Hash is
+ *   rebuilt from the key in the file.
+ */
+template<class Key, class T, class Hash = std::hash<Key>, class Equal = std::equal_to<Key>>
+class frozen_hashmap_view {
+    static_assert(std::is_trivially_copyable<Key>::value && std::is_trivially_copyable<T>::value,
+                  "frozen files hold trivially copyable keys and values only");
+    static_assert(is_keyed_hash<Hash>::value || !is_reseedable<Hash>::value,
+                  "a randomly seeded Hash needs get_key() to be saved");
+private:
+    mapped_file file;
+    const unsigned char *used;
+    const Key *keys;
+    const T *values;
+    size_t n, slots;
+    Hash hash;
+public:
+    /**
+     * map the file at path.
+     * throw runtime_error if it cannot be mapped or was not written by save_frozen for these types.
+     */
+    explicit frozen_hashmap_view(const char *path) : file(path) {
+        using namespace serialize_detail;
+        const frozen_header &h = check_frozen(file, TAG_FROZEN_HASHMAP, sizeof(Key), sizeof(T));
+        //slots必须是2的幂且大于元素个数，否则查找可能找不到空位；写入时slots至少是2n
+        if (h.slots == 0 || (h.slots & (h.slots - 1)) || h.slots <= h.count) throw runtime_error();
+        size_t avail = file.size() - ALIGN;
+        if (!fits(h.slots, 1, avail)) throw runtime_error();
+        n = h.count;
+        slots = h.slots;
+        size_t keys_at = align_up(slots);
+        if (keys_at > avail || !fits(slots, sizeof(Key), avail - keys_at)) throw runtime_error();
+        size_t values_at = keys_at + align_up(slots * sizeof(Key));
+        if (values_at > avail || !fits(slots, sizeof(T), avail - values_at)) throw runtime_error();
+        used = file.data() + ALIGN;
+        keys = reinterpret_cast<const Key *>(file.data() + ALIGN + keys_at);
+        values = reinterpret_cast<const T *>(file.data() + ALIGN + values_at);
+        hash = make_hash<Hash>(h.seed, is_keyed_hash<Hash>());
+    }
+    size_t size() const {
+        return n;
+    }
+    bool empty() const {
+        return n == 0;
+    }
+    /**
+     * returns a pointer to the mapped value of key, nullptr if key does not exist.
+     */
+    const T *find(const Key &key) const {
+        size_t i = serialize_detail::mix(hash(key)) & (slots - 1);
+        //被改坏的文件可能所有位置都标成已用，最多探查slots次
+        for (size_t k = 0; k < slots && used[i];++k) {
+            if (Equal()(keys[i], key)) return values + i;
+            i = (i + 1) & (slots - 1);
+        }
+        return nullptr;
+    }
+    size_t count(const Key &key) const {
+        return find(key) ? 1 : 0;
+    }
+    /**
+     * throw index_out_of_bound if key does not exist.
+     */
+    const T &at(const Key &key) const {
+        const T *p = find(key);
+        if (!p) throw index_out_of_bound();
+        return *p;
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,514 @@
+#ifndef SJTU_SIMD_ALGORITHM_HPP
+#define SJTU_SIMD_ALGORITHM_HPP
+
+#include "exceptions.hpp"
+#include "utility.hpp"
+#include "vector.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SJTU_SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace sjtu {
+/**
+ * search / reduce kernels over contiguous arithmetic data, e.g. the storage of an sjtu::vector.
+ * every kernel has a scalar version for any arithmetic type; int, float and uint64_t
+ *   additionally get an AVX2 version which is chosen at run time when the CPU supports it,
+ *   so the same binary runs everywhere.
+ * the vector overloads work on data() and do not depend on the iterator policy of vector.
+ * the bitwise kernels (bit_and, bit_or, bit_xor, bit_andnot, popcount) work on arrays of
+ *   uint64_t words and are the building blocks of dynamic_bitset and roaring_bitmap.
+ */
+namespace simd {
+
+//按位运算的种类，scalar和avx2里按它重载
+struct and_op {};
+struct or_op {};
+struct xor_op {};
+struct andnot_op {};
+
+/**
+ * whether the AVX2 kernels can be used on this machine, checked once.
+ */
+inline bool has_avx2() {
+#ifdef SJTU_SIMD_X86
+    static const bool res = __builtin_cpu_supports("avx2");
+    return res;
+#else
+    return false;
+#endif
+}
+
+/**
+ * the type sum() accumulates in: 64-bit integers for integers, double for floating point.
+ */
+template<typename T, bool = std::is_floating_point<T>::value, bool = std::is_signed<T>::value>
+struct sum_type {
+    typedef double type;
+};
+template<typename T>
+struct sum_type<T, false, true> {
+    typedef long long type;
+};
+template<typename T>
+struct sum_type<T, false, false> {
+    typedef unsigned long long type;
+};
+
+//标量版本，任意算术类型都可用，也用来处理SIMD剩下的尾部
+namespace scalar {
+    template<typename T>
+    const T *find(const T *first, const T *last, const T &value) {
+        for (;first != last;++first)
+            if (*first == value) return first;
+        return last;
+    }
+    template<typename T>
+    size_t count(const T *first, const T *last, const T &value) {
+        size_t res = 0;
+        for (;first != last;++first) res += (*first == value);
+        return res;
+    }
+    template<typename T>
+    void minmax(const T *first, const T *last, T &mn, T &mx) {
+        for (;first != last;++first) {
+            if (*first < mn) mn = *first;
+            if (mx < *first) mx = *first;
+        }
+    }
+    template<typename T>
+    typename sum_type<T>::type sum(const T *first, const T *last) {
+        typename sum_type<T>::type res = 0;
+        for (;first != last;++first) res += *first;
+        return res;
+    }
+    template<typename T>
+    void filter(const T *first, const T *last, const T &lo, const T &hi, vector<T> &out) {
+        for (;first != last;++first)
+            if (!(*first < lo) && !(hi < *first)) out.push_back(*first);
+    }
+    inline uint64_t apply(uint64_t a, uint64_t b, and_op) {
+        return a & b;
+    }
+    inline uint64_t apply(uint64_t a, uint64_t b, or_op) {
+        return a | b;
+    }
+    inline uint64_t apply(uint64_t a, uint64_t b, xor_op) {
+        return a ^ b;
+    }
+    inline uint64_t apply(uint64_t a, uint64_t b, andnot_op) {
+        return a & ~b;
+    }
+    template<class Op>
+    void combine(uint64_t *dst, const uint64_t *src, size_t n, Op op) {
+        for (size_t i = 0; i < n;++i) dst[i] = apply(dst[i], src[i], op);
+    }
+    inline size_t popcount(const uint64_t *p, size_t n) {
+        size_t res = 0;
+        for (size_t i = 0; i < n;++i) res += __builtin_popcountll(p[i]);
+        return res;
+    }
+}
+
+#ifdef SJTU_SIMD_X86
+//AVX2版本，每次处理一个256位的块，剩下不足一块的交给标量版本
+namespace avx2 {
+    //比较结果的掩码，每个元素一位
+    __attribute__((target("avx2"))) inline int mask(__m256i cmp, int) {
+        return _mm256_movemask_ps(_mm256_castsi256_ps(cmp));
+    }
+    __attribute__((target("avx2"))) inline int mask(__m256i cmp, uint64_t) {
+        return _mm256_movemask_pd(_mm256_castsi256_pd(cmp));
+    }
+    __attribute__((target("avx2"))) inline int mask(__m256 cmp, float) {
+        return _mm256_movemask_ps(cmp);
+    }
+    __attribute__((target("avx2"))) inline __m256i load(const int *p) {
+        return _mm256_loadu_si256((const __m256i *)p);
+    }
+    __attribute__((target("avx2"))) inline __m256i load(const uint64_t *p) {
+        return _mm256_loadu_si256((const __m256i *)p);
+    }
+    __attribute__((target("avx2"))) inline __m256 load(const float *p) {
+        return _mm256_loadu_ps(p);
+    }
+    __attribute__((target("avx2"))) inline __m256i broadcast(int v) {
+        return _mm256_set1_epi32(v);
+    }
+    __attribute__((target("avx2"))) inline __m256i broadcast(uint64_t v) {
+        return _mm256_set1_epi64x((long long)v);
+    }
+    __attribute__((target("avx2"))) inline __m256 broadcast(float v) {
+        return _mm256_set1_ps(v);
+    }
+    __attribute__((target("avx2"))) inline __m256i equal(__m256i a, __m256i b, int) {
+        return _mm256_cmpeq_epi32(a, b);
+    }
+    __attribute__((target("avx2"))) inline __m256i equal(__m256i a, __m256i b, uint64_t) {
+        return _mm256_cmpeq_epi64(a, b);
+    }
+    __attribute__((target("avx2"))) inline __m256 equal(__m256 a, __m256 b, float) {
+        return _mm256_cmp_ps(a, b, _CMP_EQ_OQ);
+    }
+    //a < b 的掩码，uint64_t翻转符号位后用有符号比较
+    __attribute__((target("avx2"))) inline __m256i less(__m256i a, __m256i b, int) {
+        return _mm256_cmpgt_epi32(b, a);
+    }
+    __attribute__((target("avx2"))) inline __m256i less(__m256i a, __m256i b, uint64_t) {
+        const __m256i sign = _mm256_set1_epi64x((long long)0x8000000000000000ULL);
+        return _mm256_cmpgt_epi64(_mm256_xor_si256(b, sign), _mm256_xor_si256(a, sign));
+    }
+    __attribute__((target("avx2"))) inline __m256 less(__m256 a, __m256 b, float) {
+        return _mm256_cmp_ps(a, b, _CMP_LT_OQ);
+    }
+    __attribute__((target("avx2"))) inline __m256i either(__m256i a, __m256i b) {
+        return _mm256_or_si256(a, b);
+    }
+    __attribute__((target("avx2"))) inline __m256 either(__m256 a, __m256 b) {
+        return _mm256_or_ps(a, b);
+    }
+
+    template<typename T>
+    __attribute__((target("avx2"))) const T *find(const T *first, const T *last, const T &value) {
+        const size_t step = 32 / sizeof(T);
+        auto v = broadcast(value);
+        for (;(size_t)(last - first) >= step;first += step) {
+            int m = mask(equal(load(first), v, T()), T());
+            if (m) return first + __builtin_ctz(m);
+        }
+        return scalar::find(first, last, value);
+    }
+    template<typename T>
+    __attribute__((target("avx2"))) size_t count(const T *first, const T *last, const T &value) {
+        const size_t step = 32 / sizeof(T);
+        size_t res = 0;
+        auto v = broadcast(value);
+        for (;(size_t)(last - first) >= step;first += step)
+            res += __builtin_popcount(mask(equal(load(first), v, T()), T()));
+        return res + scalar::count(first, last, value);
+    }
+    template<typename T>
+    __attribute__((target("avx2"))) void filter(const T *first, const T *last, const T &lo, const T &hi, vector<T> &out) {
+        const size_t step = 32 / sizeof(T);
+        auto l = broadcast(lo), h = broadcast(hi);
+        for (;(size_t)(last - first) >= step;first += step) {
+            auto x = load(first);
+            //在[lo, hi]之外的元素
+            int m = mask(either(less(x, l, T()), less(h, x, T())), T());
+            m = ~m & ((1 << step) - 1);
+            while (m) {
+                out.push_back(first[__builtin_ctz(m)]);
+                m &= m - 1;
+            }
+        }
+        scalar::filter(first, last, lo, hi, out);
+    }
+
+    __attribute__((target("avx2"))) inline void minmax(const int *first, const int *last, int &mn, int &mx) {
+        if (last - first >= 8) {
+            __m256i vmn = load(first), vmx = vmn;
+            for (first += 8;last - first >= 8;first += 8) {
+                __m256i x = load(first);
+                vmn = _mm256_min_epi32(vmn, x);
+                vmx = _mm256_max_epi32(vmx, x);
+            }
+            int a[8], b[8];
+            _mm256_storeu_si256((__m256i *)a, vmn);
+            _mm256_storeu_si256((__m256i *)b, vmx);
+            scalar::minmax(a, a + 8, mn, mx);
+            scalar::minmax(b, b + 8, mn, mx);
+        }
+        scalar::minmax(first, last, mn, mx);
+    }
+    __attribute__((target("avx2"))) inline void minmax(const float *first, const float *last, float &mn, float &mx) {
+        if (last - first >= 8) {
+            __m256 vmn = load(first), vmx = vmn;
+            for (first += 8;last - first >= 8;first += 8) {
+                __m256 x = load(first);
+                vmn = _mm256_min_ps(vmn, x);
+                vmx = _mm256_max_ps(vmx, x);
+            }
+            float a[8], b[8];
+            _mm256_storeu_ps(a, vmn);
+            _mm256_storeu_ps(b, vmx);
+            scalar::minmax(a, a + 8, mn, mx);
+            scalar::minmax(b, b + 8, mn, mx);
+        }
+        scalar::minmax(first, last, mn, mx);
+    }
+    __attribute__((target("avx2"))) inline void minmax(const uint64_t *first, const uint64_t *last, uint64_t &mn, uint64_t &mx) {
+        if (last - first >= 4) {
+            __m256i vmn = load(first), vmx = vmn;
+            for (first += 4;last - first >= 4;first += 4) {
+                __m256i x = load(first);
+                vmn = _mm256_blendv_epi8(vmn, x, less(x, vmn, uint64_t()));
+                vmx = _mm256_blendv_epi8(vmx, x, less(vmx, x, uint64_t()));
+            }
+            uint64_t a[4], b[4];
+            _mm256_storeu_si256((__m256i *)a, vmn);
+            _mm256_storeu_si256((__m256i *)b, vmx);
+            scalar::minmax(a, a + 4, mn, mx);
+            scalar::minmax(b, b + 4, mn, mx);
+        }
+        scalar::minmax(first, last, mn, mx);
+    }
+
+    __attribute__((target("avx2"))) inline long long sum(const int *first, const int *last) {
+        __m256i acc = _mm256_setzero_si256();
+        for (;last - first >= 8;first += 8) {
+            __m256i x = load(first);
+            acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(x)));
+            acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(x, 1)));
+        }
+        long long a[4];
+        _mm256_storeu_si256((__m256i *)a, acc);
+        return a[0] + a[1] + a[2] + a[3] + scalar::sum(first, last);
+    }
+    __attribute__((target("avx2"))) inline double sum(const float *first, const float *last) {
+        __m256d acc = _mm256_setzero_pd();
+        for (;last - first >= 8;first += 8) {
+            __m256 x = load(first);
+            acc = _mm256_add_pd(acc, _mm256_cvtps_pd(_mm256_castps256_ps128(x)));
+            acc = _mm256_add_pd(acc, _mm256_cvtps_pd(_mm256_extractf128_ps(x, 1)));
+        }
+        double a[4];
+        _mm256_storeu_pd(a, acc);
+        return a[0] + a[1] + a[2] + a[3] + scalar::sum(first, last);
+    }
+    __attribute__((target("avx2"))) inline unsigned long long sum(const uint64_t *first, const uint64_t *last) {
+        __m256i acc = _mm256_setzero_si256();
+        for (;last - first >= 4;first += 4) acc = _mm256_add_epi64(acc, load(first));
+        uint64_t a[4];
+        _mm256_storeu_si256((__m256i *)a, acc);
+        return a[0] + a[1] + a[2] + a[3] + scalar::sum(first, last);
+    }
+
+    __attribute__((target("avx2"))) inline __m256i apply(__m256i a, __m256i b, and_op) {
+        return _mm256_and_si256(a, b);
+    }
+    __attribute__((target("avx2"))) inline __m256i apply(__m256i a, __m256i b, or_op) {
+        return _mm256_or_si256(a, b);
+    }
+    __attribute__((target("avx2"))) inline __m256i apply(__m256i a, __m256i b, xor_op) {
+        return _mm256_xor_si256(a, b);
+    }
+    __attribute__((target("avx2"))) inline __m256i apply(__m256i a, __m256i b, andnot_op) {
+        return _mm256_andnot_si256(b, a);
+    }
+    template<class Op>
+    __attribute__((target("avx2"))) void combine(uint64_t *dst, const uint64_t *src, size_t n, Op op) {
+        size_t i = 0;
+        for (;i + 4 <= n;i += 4)
+            _mm256_storeu_si256((__m256i *)(dst + i), apply(load(dst + i), load(src + i), op));
+        scalar::combine(dst + i, src + i, n - i, op);
+    }
+    //每个字节查表算出高低4位的1的个数，再用sad把32个字节的结果加成4个64位数
+    __attribute__((target("avx2"))) inline size_t popcount(const uint64_t *p, size_t n) {
+        const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                               0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m256i low = _mm256_set1_epi8(0x0f);
+        __m256i acc = _mm256_setzero_si256();
+        size_t i = 0;
+        for (;i + 4 <= n;i += 4) {
+            __m256i x = load(p + i);
+            __m256i cnt = _mm256_add_epi8(_mm256_shuffle_epi8(table, _mm256_and_si256(x, low)),
+                                          _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(x, 4), low)));
+            acc = _mm256_add_epi64(acc, _mm256_sad_epu8(cnt, _mm256_setzero_si256()));
+        }
+        uint64_t a[4];
+        _mm256_storeu_si256((__m256i *)a, acc);
+        return size_t(a[0] + a[1] + a[2] + a[3]) + scalar::popcount(p + i, n - i);
+    }
+}
+#endif
+
+//只有int、float、uint64_t有向量化版本
+template<typename T>
+struct vectorized {
+    static const bool value = std::is_same<T, int>::value || std::is_same<T, float>::value
+                              || std::is_same<T, uint64_t>::value;
+};
+
+template<typename T>
+typename std::enable_if<vectorized<T>::value, bool>::type use_avx2() {
+    return has_avx2();
+}
+template<typename T>
+typename std::enable_if<!vectorized<T>::value, bool>::type use_avx2() {
+    return false;
+}
+
+#ifdef SJTU_SIMD_X86
+#define SJTU_SIMD_DISPATCH(T, call) \
+    if (use_avx2<T>()) return avx2::call; \
+    return scalar::call;
+#else
+#define SJTU_SIMD_DISPATCH(T, call) \
+    return scalar::call;
+#endif
+
+template<typename T>
+typename std::enable_if<vectorized<T>::value, const T *>::type
+find_impl(const T *first, const T *last, const T &value) {
+    SJTU_SIMD_DISPATCH(T, find(first, last, value))
+}
+template<typename T>
+typename std::enable_if<!vectorized<T>::value, const T *>::type
+find_impl(const T *first, const T *last, const T &value) {
+    return scalar::find(first, last, value);
+}
+template<typename T>
+typename std::enable_if<vectorized<T>::value, size_t>::type
+count_impl(const T *first, const T *last, const T &value) {
+    SJTU_SIMD_DISPATCH(T, count(first, last, value))
+}
+template<typename T>
+typename std::enable_if<!vectorized<T>::value, size_t>::type
+count_impl(const T *first, const T *last, const T &value) {
+    return scalar::count(first, last, value);
+}
+template<typename T>
+typename std::enable_if<vectorized<T>::value>::type
+minmax_impl(const T *first, const T *last, T &mn, T &mx) {
+    SJTU_SIMD_DISPATCH(T, minmax(first, last, mn, mx))
+}
+template<typename T>
+typename std::enable_if<!vectorized<T>::value>::type
+minmax_impl(const T *first, const T *last, T &mn, T &mx) {
+    scalar::minmax(first, last, mn, mx);
+}
+template<typename T>
+typename std::enable_if<vectorized<T>::value, typename sum_type<T>::type>::type
+sum_impl(const T *first, const T *last) {
+    SJTU_SIMD_DISPATCH(T, sum(first, last))
+}
+template<typename T>
+typename std::enable_if<!vectorized<T>::value, typename sum_type<T>::type>::type
+sum_impl(const T *first, const T *last) {
+    return scalar::sum(first, last);
+}
+template<typename T>
+typename std::enable_if<vectorized<T>::value>::type
+filter_impl(const T *first, const T *last, const T &lo, const T &hi, vector<T> &out) {
+    SJTU_SIMD_DISPATCH(T, filter(first, last, lo, hi, out))
+}
+template<typename T>
+typename std::enable_if<!vectorized<T>::value>::type
+filter_impl(const T *first, const T *last, const T &lo, const T &hi, vector<T> &out) {
+    scalar::filter(first, last, lo, hi, out);
+}
+
+template<class Op>
+void combine_impl(uint64_t *dst, const uint64_t *src, size_t n, Op op) {
+    SJTU_SIMD_DISPATCH(uint64_t, combine(dst, src, n, op))
+}
+inline size_t popcount_impl(const uint64_t *p, size_t n) {
+    SJTU_SIMD_DISPATCH(uint64_t, popcount(p, n))
+}
+
+#undef SJTU_SIMD_DISPATCH
+
+/**
+ * returns a pointer to the first element equal to value in [first, last), or last.
+ */
+template<typename T>
+const T *find(const T *first, const T *last, const T &value) {
+    static_assert(std::is_arithmetic<T>::value, "simd kernels need an arithmetic type");
+    return find_impl(first, last, value);
+}
+/**
+ * returns the index of the first element equal to value, or v.size() if there is none.
+ */
+template<typename T>
+size_t find(const vector<T> &v, const T &value) {
+    return find(v.data(), v.data() + v.size(), value) - v.data();
+}
+/**
+ * returns the number of elements equal to value.
+ */
+template<typename T>
+size_t count(const T *first, const T *last, const T &value) {
+    static_assert(std::is_arithmetic<T>::value, "simd kernels need an arithmetic type");
+    return count_impl(first, last, value);
+}
+template<typename T>
+size_t count(const vector<T> &v, const T &value) {
+    return count(v.data(), v.data() + v.size(), value);
+}
+/**
+ * returns the pair (smallest element, largest element).
+ * throw container_is_empty if the range is empty.
+ * for floating point the result is unspecified if the range contains NaN.
+ */
+template<typename T>
+pair<T, T> minmax(const T *first, const T *last) {
+    static_assert(std::is_arithmetic<T>::value, "simd kernels need an arithmetic type");
+    if (first == last) throw container_is_empty();
+    T mn = *first, mx = *first;
+    minmax_impl(first, last, mn, mx);
+    return pair<T, T>(mn, mx);
+}
+template<typename T>
+pair<T, T> minmax(const vector<T> &v) {
+    return minmax(v.data(), v.data() + v.size());
+}
+/**
+ * returns the sum of the elements, accumulated in sum_type<T>::type.
+ * the vectorized floating point sum adds in a different order from a plain loop,
+ *   so the last bits may differ.
+ */
+template<typename T>
+typename sum_type<T>::type sum(const T *first, const T *last) {
+    static_assert(std::is_arithmetic<T>::value, "simd kernels need an arithmetic type");
+    return sum_impl(first, last);
+}
+template<typename T>
+typename sum_type<T>::type sum(const vector<T> &v) {
+    return sum(v.data(), v.data() + v.size());
+}
+/**
+ * appends every element x with lo <= x <= hi to out, keeping their order.
+ */
+template<typename T>
+void filter(const T *first, const T *last, const T &lo, const T &hi, vector<T> &out) {
+    static_assert(std::is_arithmetic<T>::value, "simd kernels need an arithmetic type");
+    filter_impl(first, last, lo, hi, out);
+}
+template<typename T>
+vector<T> filter(const vector<T> &v, const T &lo, const T &hi) {
+    vector<T> out;
+    filter(v.data(), v.data() + v.size(), lo, hi, out);
+    return out;
+}
+/**
+ * dst[i] = dst[i] & src[i] (| for bit_or, ^ for bit_xor, & ~ for bit_andnot) for i in [0, n).
+ * dst and src may be the same array but must not overlap otherwise.
+ */
+inline void bit_and(uint64_t *dst, const uint64_t *src, size_t n) {
+    combine_impl(dst, src, n, and_op());
+}
+inline void bit_or(uint64_t *dst, const uint64_t *src, size_t n) {
+    combine_impl(dst, src, n, or_op());
+}
+inline void bit_xor(uint64_t *dst, const uint64_t *src, size_t n) {
+    combine_impl(dst, src, n, xor_op());
+}
+inline void bit_andnot(uint64_t *dst, const uint64_t *src, size_t n) {
+    combine_impl(dst, src, n, andnot_op());
+}
+/**
+ * returns the number of set bits in the n words at p.
+ */
+inline size_t popcount(const uint64_t *p, size_t n) {
+    return popcount_impl(p, n);
+}
+
+}
+
+}
+
+#endif
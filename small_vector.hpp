@@ -0,0 +1,324 @@
+#ifndef SJTU_SMALL_VECTOR_HPP
+#define SJTU_SMALL_VECTOR_HPP
+
+#include "exceptions.hpp"
+#include "vector.hpp"
+#include <cstdlib>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace sjtu {
+/**
+ * a data container like vector, but the first N elements are stored inside the object itself
+ *   so that a small_vector holding no more than N elements never touches the heap.
+ * beyond N elements it spills to a heap buffer which grows by doubling, like vector.
+ * the interfaces (iterators, bounds checking and exceptions) are the same as vector.
+ */
+template<typename T, size_t N = 8>
+class small_vector {
+    static_assert(N > 0, "small_vector needs at least one inline slot");
+private:
+    alignas(T) unsigned char buf[N * sizeof(T)];
+    T *elems;
+    size_t cur_len;
+    size_t max_len;
+    T *inline_data() {
+        return reinterpret_cast<T *>(buf);
+    }
+    bool is_inline() const {
+        return elems == reinterpret_cast<const T *>(buf);
+    }
+    //把元素搬到一块大小为new_len(>=cur_len)的新空间，new_len<=N时搬回对象内部
+    void reallocate(size_t new_len){
+        T *tmp = elems;
+        bool was_inline = is_inline();
+        if (new_len <= N) {
+            if (was_inline) return;
+            elems = inline_data();
+            new_len = N;
+        }
+        else elems = vector_detail::allocate<T>(new_len);
+        for (size_t i = 0; i < cur_len;++i){
+            new (elems + i) T(std::move(tmp[i]));
+            tmp[i].~T();
+        }
+        max_len = new_len;
+        if (!was_inline) free(tmp);
+    }
+    void doubleSpace(){
+        reallocate(2 * max_len);
+    }
+    //other的元素搬进来，other只剩空的内部空间
+    void steal(small_vector &other){
+        if (other.is_inline()) {
+            elems = inline_data();
+            max_len = N;
+            for (size_t i = 0; i < other.cur_len;++i){
+                new (elems + i) T(std::move(other.elems[i]));
+                other.elems[i].~T();
+            }
+        }
+        else {
+            elems = other.elems;
+            max_len = other.max_len;
+            other.elems = other.inline_data();
+            other.max_len = N;
+        }
+        cur_len = other.cur_len;
+        other.cur_len = 0;
+    }
+public:
+    //与vector相同，定义SJTU_VECTOR_UNCHECKED时operator[]不检查边界、迭代器就是指针
+#ifdef SJTU_VECTOR_UNCHECKED
+    typedef T *iterator;
+    typedef const T *const_iterator;
+private:
+    size_t index_of(const_iterator it) const {
+        return it - elems;
+    }
+    iterator make_iterator(size_t po) {
+        return elems + po;
+    }
+    const_iterator make_iterator(size_t po) const {
+        return elems + po;
+    }
+public:
+#else
+    typedef vector_detail::iterator<small_vector, T> iterator;
+    typedef vector_detail::const_iterator<small_vector, T> const_iterator;
+private:
+    size_t index_of(const const_iterator &it) const {
+        return it.po;
+    }
+    iterator make_iterator(size_t po) {
+        return iterator(po, this);
+    }
+    const_iterator make_iterator(size_t po) const {
+        return const_iterator(po, this);
+    }
+public:
+#endif
+    small_vector() {
+        elems = inline_data();
+        cur_len = 0;
+        max_len = N;
+    }
+    small_vector(const small_vector &other) {
+        elems = inline_data();
+        cur_len = 0;
+        max_len = N;
+        reserve(other.cur_len);
+        for (size_t i = 0; i < other.cur_len;++i) new (elems + i) T(other.elems[i]);
+        cur_len = other.cur_len;
+    }
+    /**
+     * move constructor, takes over the heap buffer of other in O(1);
+     *   inline elements can only be moved one by one, so it is noexcept only if moving T is.
+     */
+    small_vector(small_vector &&other) noexcept(std::is_nothrow_move_constructible<T>::value) {
+        steal(other);
+    }
+    ~small_vector() {
+        clear();
+        if (!is_inline()) free(elems);
+    }
+    small_vector &operator=(const small_vector &other) {
+        if (this==&other) return *this;
+        clear();
+        reserve(other.cur_len);
+        for (size_t i = 0; i < other.cur_len;++i) new (elems + i) T(other.elems[i]);
+        cur_len = other.cur_len;
+        return *this;
+    }
+    small_vector &operator=(small_vector &&other) noexcept(std::is_nothrow_move_constructible<T>::value) {
+        if (this==&other) return *this;
+        clear();
+        if (!is_inline()) free(elems);
+        steal(other);
+        return *this;
+    }
+    void swap(small_vector &other) noexcept(std::is_nothrow_move_constructible<T>::value) {
+        small_vector tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+    /**
+     * assigns specified element with bounds checking
+     * throw index_out_of_bound if pos is not in [0, size)
+     */
+    T & at(const size_t &pos) {
+        if (pos>=cur_len) throw index_out_of_bound();
+        return this->elems[pos];
+    }
+    const T & at(const size_t &pos) const {
+        if (pos>=cur_len) throw index_out_of_bound();
+        return this->elems[pos];
+    }
+    T & operator[](const size_t &pos) {
+#ifndef SJTU_VECTOR_UNCHECKED
+        if (pos>=cur_len) throw index_out_of_bound();
+#endif
+        return this->elems[pos];
+    }
+    const T & operator[](const size_t &pos) const {
+#ifndef SJTU_VECTOR_UNCHECKED
+        if (pos>=cur_len) throw index_out_of_bound();
+#endif
+        return this->elems[pos];
+    }
+    T * data() {
+        return this->elems;
+    }
+    const T * data() const {
+        return this->elems;
+    }
+    /**
+     * access the first / last element.
+     * throw container_is_empty if size == 0
+     */
+    const T & front() const {
+        if (cur_len==0) throw container_is_empty();
+        return this->elems[0];
+    }
+    const T & back() const {
+        if (cur_len==0) throw container_is_empty();
+        return this->elems[cur_len - 1];
+    }
+    iterator begin() {
+        return make_iterator(0);
+    }
+    const_iterator begin() const {
+        return make_iterator(0);
+    }
+    const_iterator cbegin() const {
+        return make_iterator(0);
+    }
+    iterator end() {
+        return make_iterator(cur_len);
+    }
+    const_iterator end() const {
+        return make_iterator(cur_len);
+    }
+    const_iterator cend() const {
+        return make_iterator(cur_len);
+    }
+    bool empty() const {
+        return cur_len == 0;
+    }
+    size_t size() const {
+        return cur_len;
+    }
+    /**
+     * returns the number of elements that can be held without reallocation, at least N.
+     */
+    size_t capacity() const {
+        return max_len;
+    }
+    /**
+     * returns whether the elements currently live in the inline buffer.
+     */
+    bool small() const {
+        return is_inline();
+    }
+    /**
+     * increases the capacity to at least new_cap.
+     */
+    void reserve(size_t new_cap) {
+        if (new_cap > max_len) reallocate(new_cap);
+    }
+    /**
+     * reduces the capacity to size(), moving the elements back inline if they fit.
+     */
+    void shrink_to_fit() {
+        if (max_len > cur_len && !is_inline()) reallocate(cur_len);
+    }
+    void clear() {
+        for (size_t i = 0; i < cur_len;++i){
+            elems[i].~T();
+        }
+        cur_len = 0;
+    }
+    /**
+     * inserts value at index ind.
+     * returns an iterator pointing to the inserted value.
+     * throw index_out_of_bound if ind > size
+     */
+    iterator insert(const size_t &ind, const T &value) {
+        if (ind>cur_len) throw index_out_of_bound();
+        if (cur_len==max_len) {
+            //value可能就是容器内的元素，扩容前先拷出来
+            T tmp(value);
+            doubleSpace();
+            return insert(ind, tmp);
+        }
+        if (ind==cur_len) new (elems + cur_len) T(value);
+        else if (&value >= elems && &value < elems + cur_len) {
+            //value是容器内的元素，后移会改动它，与vector::insert一样先拷出来
+            T tmp(value);
+            return insert(ind, tmp);
+        }
+        else {
+            new (elems + cur_len) T(std::move(elems[cur_len - 1]));
+            for (size_t i = cur_len - 1; i > ind;--i) elems[i] = std::move(elems[i - 1]);
+            elems[ind] = value;
+        }
+        ++cur_len;
+        return make_iterator(ind);
+    }
+    iterator insert(iterator pos, const T &value) {
+        return insert(index_of(pos), value);
+    }
+    /**
+     * removes the element with index ind.
+     * return an iterator pointing to the following element.
+     * throw index_out_of_bound if ind >= size
+     */
+    iterator erase(const size_t &ind) {
+        if (ind>=cur_len) throw index_out_of_bound();
+        for (size_t i = ind; i + 1 < cur_len;++i) elems[i] = std::move(elems[i + 1]);
+        --cur_len;
+        elems[cur_len].~T();
+        return make_iterator(ind);
+    }
+    iterator erase(iterator pos) {
+        return erase(index_of(pos));
+    }
+#ifdef SJTU_VECTOR_UNCHECKED
+    //迭代器是指针时字面量0既能转成size_t也能转成迭代器，按下标处理
+    iterator insert(int ind, const T &value) {
+        return insert(size_t(ind), value);
+    }
+    iterator erase(int ind) {
+        return erase(size_t(ind));
+    }
+#endif
+    void push_back(const T &value) {
+        if (cur_len==max_len) {
+            T tmp(value);
+            doubleSpace();
+            new (elems + cur_len) T(std::move(tmp));
+        }
+        else new (elems + cur_len) T(value);
+        ++cur_len;
+    }
+    /**
+     * remove the last element from the end.
+     * throw container_is_empty if size() == 0
+     */
+    void pop_back() {
+        if (cur_len==0) throw container_is_empty();
+        --cur_len;
+        elems[cur_len].~T();
+    }
+};
+
+template<typename T, size_t N>
+void swap(small_vector<T, N> &a, small_vector<T, N> &b) noexcept(std::is_nothrow_move_constructible<T>::value) {
+    a.swap(b);
+}
+
+}
+
+#endif
@@ -0,0 +1,113 @@
+#ifndef SJTU_SORT_HPP
+#define SJTU_SORT_HPP
+
+#include <cstddef>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <utility>
+#include "vector.hpp"
+#include "thread_pool.hpp"
+#include "sequential_sort.hpp"
+
+namespace sjtu {
+/**
+ * sorting routines over contiguous ranges [first, last) and sjtu::vector:
+ *   intro_sort     quicksort falling back to heapsort, insertion sort on short ranges; not stable
+ *   merge_sort     stable, O(n) extra memory
+ *   radix_sort     LSD radix sort for integer keys, stable, O(n) extra memory
+ *   parallel_sort  sorts chunks on a thread_pool and merges them, for large inputs
+ * the range versions of the first three live in sequential_sort.hpp.
+ */
+namespace sort_detail {
+    //把src中相邻的有序段[a, b)和[b, c)归并到dst的[a, c)，两边都是已构造的元素
+    template<class T, class Compare>
+    void merge_runs(T *src, T *dst, size_t a, size_t b, size_t c, Compare &cmp) {
+        size_t i = a, j = b, k = a;
+        while (i < b && j < c) {
+            if (cmp(src[j], src[i])) dst[k++] = std::move(src[j++]);
+            else dst[k++] = std::move(src[i++]);
+        }
+        while (i < b) dst[k++] = std::move(src[i++]);
+        while (j < c) dst[k++] = std::move(src[j++]);
+    }
+}
+
+/**
+ * the algorithms of sequential_sort.hpp applied to a whole vector.
+ */
+template<class T, class Compare = std::less<T>>
+void intro_sort(vector<T> &v, Compare cmp = Compare()) {
+    intro_sort(v.data(), v.data() + v.size(), cmp);
+}
+template<class T, class Compare = std::less<T>>
+void merge_sort(vector<T> &v, Compare cmp = Compare()) {
+    merge_sort(v.data(), v.data() + v.size(), cmp);
+}
+template<class T>
+void radix_sort(vector<T> &v) {
+    radix_sort(v.data(), v.data() + v.size());
+}
+template<class T, class KeyOf>
+void radix_sort(vector<T> &v, KeyOf key) {
+    radix_sort(v.data(), v.data() + v.size(), key);
+}
+
+/**
+ * sort [first, last) with cmp on pool, not stable.
+ * ranges shorter than threshold (or a pool with one worker) are sorted by intro_sort directly;
+ *   otherwise the range is cut into one chunk per worker, the chunks are sorted in parallel
+ *   and then merged pairwise, each round of merges also running in parallel.
+ */
+template<class T, class Compare = std::less<T>>
+void parallel_sort(T *first, T *last, Compare cmp = Compare(),
+                   thread_pool &pool = thread_pool::shared(), size_t threshold = 1 << 16) {
+    size_t n = last - first;
+    size_t chunks = pool.size();
+    if (n < threshold || chunks < 2) {
+        intro_sort(first, last, cmp);
+        return;
+    }
+    size_t *bound = new size_t[chunks + 1];
+    for (size_t i = 0; i <= chunks;++i) bound[i] = n / chunks * i + (i < n % chunks ? i : n % chunks);
+    {
+        task_group group(pool);
+        for (size_t i = 0; i < chunks;++i) {
+            T *l = first + bound[i], *r = first + bound[i + 1];
+            group.run([l, r, cmp] { intro_sort(l, r, cmp); });
+        }
+        group.wait();
+    }
+    //buf里先搬入所有元素，之后两边都是已构造的，来回归并
+    T *buf = (T *)malloc(n * sizeof(T));
+    for (size_t i = 0; i < n;++i) new (buf + i) T(std::move(first[i]));
+    T *src = buf, *dst = first;
+    for (size_t width = 1; width < chunks; width <<= 1) {
+        task_group group(pool);
+        for (size_t i = 0; i < chunks; i += 2 * width) {
+            size_t a = bound[i];
+            size_t b = bound[i + width < chunks ? i + width : chunks];
+            size_t c = bound[i + 2 * width < chunks ? i + 2 * width : chunks];
+            group.run([src, dst, a, b, c, cmp]() mutable { sort_detail::merge_runs(src, dst, a, b, c, cmp); });
+        }
+        group.wait();
+        T *tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+    if (src != first) {
+        for (size_t i = 0; i < n;++i) first[i] = std::move(src[i]);
+    }
+    for (size_t i = 0; i < n;++i) buf[i].~T();
+    free(buf);
+    delete [] bound;
+}
+template<class T, class Compare = std::less<T>>
+void parallel_sort(vector<T> &v, Compare cmp = Compare(),
+                   thread_pool &pool = thread_pool::shared(), size_t threshold = 1 << 16) {
+    parallel_sort(v.data(), v.data() + v.size(), cmp, pool, threshold);
+}
+
+}
+
+#endif
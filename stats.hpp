@@ -0,0 +1,70 @@
+#ifndef SJTU_STATS_HPP
+#define SJTU_STATS_HPP
+
+#include <cstddef>
+
+/**
+ * opt-in counters inside the containers.
+ * compile with SJTU_STATS defined to collect them; every container then keeps a counters
+ *   member which stats() returns. without SJTU_STATS the member and every update to it
+ *   disappear, and stats() returns all zeros.
+ * allocations count heap blocks, e.g. a map element is one block for the node and one for
+ *   the value. the counters describe the history of one container object and are neither
+ *   copied nor swapped with its contents.
+ */
+#ifdef SJTU_STATS
+#define SJTU_STAT(...) __VA_ARGS__
+#else
+#define SJTU_STAT(...)
+#endif
+
+namespace sjtu {
+
+class vector_stats {
+public:
+    size_t allocations = 0;
+    size_t bytes_allocated = 0;
+    //缓冲区满了而扩容的次数（doubleSpace和批量插入）
+    size_t grows = 0;
+    //扩容、shrink_to_fit时搬到新缓冲区的字节数
+    size_t bytes_copied = 0;
+};
+
+class map_stats {
+public:
+    size_t allocations = 0;
+    size_t bytes_allocated = 0;
+    //单旋的次数，双旋算两次
+    size_t rotations = 0;
+    //调用stats()时树的高度
+    int height = 0;
+};
+
+class hashmap_stats {
+public:
+    static const size_t CHAIN_HISTOGRAM = 16;
+    size_t allocations = 0;
+    size_t bytes_allocated = 0;
+    //重新分配哈希表的次数
+    size_t resizes = 0;
+    //链过长而换种子重新散列的次数，只有可重新播种的Hash才会发生
+    size_t reseeds = 0;
+    //调用stats()时：chains[i]为恰有i个元素的桶数，最后一项也包括更长的链
+    size_t chains[CHAIN_HISTOGRAM] = {};
+    size_t longest_chain = 0;
+};
+
+class priority_queue_stats {
+public:
+    size_t allocations = 0;
+    size_t bytes_allocated = 0;
+    //push、pop、merge各算一次合并，merge_steps为merge_的递归调用总数
+    size_t merges = 0;
+    size_t merge_steps = 0;
+    //单次合并中最深的递归层数，即走过的右路径长度
+    size_t max_merge_depth = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,143 @@
+/*
+ * checks that moving and swapping the containers copies no element and allocates nothing.
+ * build with the support headers on the include path, e.g.
+ *   g++ -std=c++14 -I.. move_test.cpp && ./a.out
+ */
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "../vector.hpp"
+#include "../small_vector.hpp"
+#include "../list.hpp"
+#include "../map.hpp"
+#include "../linked_hashmap.hpp"
+#include "../priority_queue.hpp"
+
+//全局operator new的调用次数
+static size_t allocations = 0;
+void *operator new(size_t n) {
+    ++allocations;
+    void *p = malloc(n ? n : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void operator delete(void *p) noexcept {
+    free(p);
+}
+void operator delete(void *p, size_t) noexcept {
+    free(p);
+}
+
+//记录拷贝次数的元素类型
+class counted {
+public:
+    static size_t copies;
+    int v;
+    counted(int _v = 0) : v(_v) {}
+    counted(const counted &other) : v(other.v) {
+        ++copies;
+    }
+    counted(counted &&other) noexcept : v(other.v) {}
+    counted &operator=(const counted &other) {
+        ++copies;
+        v = other.v;
+        return *this;
+    }
+    counted &operator=(counted &&other) noexcept {
+        v = other.v;
+        return *this;
+    }
+    bool operator<(const counted &other) const {
+        return v < other.v;
+    }
+};
+size_t counted::copies = 0;
+
+//a、b已经装好元素，移动构造、移动赋值、成员swap、非成员swap都不能拷贝元素或分配内存
+template<class C, class Check>
+void check(const char *name, C &a, C &b, Check same) {
+    static_assert(std::is_nothrow_move_constructible<C>::value, "move constructor must be noexcept");
+    static_assert(std::is_nothrow_move_assignable<C>::value, "move assignment must be noexcept");
+    C ref_a(a), ref_b(b);
+    size_t copies = counted::copies, allocs = allocations;
+    C c(std::move(a));
+    a = std::move(b);
+    b = std::move(c);
+    a.swap(b);
+    using sjtu::swap;
+    swap(a, b);
+    c = std::move(a);
+    a = std::move(c);
+    assert(counted::copies == copies);
+    assert(allocations == allocs);
+    assert(same(a, ref_b) && same(b, ref_a) && c.empty());
+    printf("%s: ok\n", name);
+}
+
+template<class C>
+bool same_seq(const C &x, const C &y) {
+    if (x.size() != y.size()) return false;
+    typename C::const_iterator i = x.cbegin(), j = y.cbegin();
+    for (; i != x.cend(); ++i, ++j)
+        if ((*i).v != (*j).v) return false;
+    return true;
+}
+template<class C>
+bool same_map(const C &x, const C &y) {
+    if (x.size() != y.size()) return false;
+    typename C::const_iterator i = x.cbegin(), j = y.cbegin();
+    for (; i != x.cend(); ++i, ++j)
+        if ((*i).first != (*j).first || (*i).second.v != (*j).second.v) return false;
+    return true;
+}
+template<class C>
+bool same_queue(C x, C y) {
+    if (x.size() != y.size()) return false;
+    for (; !x.empty(); x.pop(), y.pop())
+        if (x.top().v != y.top().v) return false;
+    return true;
+}
+
+int main() {
+    {
+        sjtu::vector<counted> a, b;
+        for (int i = 0; i < 100; ++i) a.push_back(counted(i));
+        for (int i = 0; i < 7; ++i) b.push_back(counted(-i));
+        check("vector", a, b, same_seq<sjtu::vector<counted> >);
+    }
+    {
+        sjtu::small_vector<counted, 8> a, b;
+        for (int i = 0; i < 100; ++i) a.push_back(counted(i));
+        for (int i = 0; i < 7; ++i) b.push_back(counted(-i));
+        check("small_vector", a, b, same_seq<sjtu::small_vector<counted, 8> >);
+    }
+    {
+        sjtu::list<counted> a, b;
+        for (int i = 0; i < 100; ++i) a.push_back(counted(i));
+        for (int i = 0; i < 7; ++i) b.push_back(counted(-i));
+        a.reverse();
+        check("list", a, b, same_seq<sjtu::list<counted> >);
+    }
+    {
+        sjtu::map<int, counted> a, b;
+        for (int i = 0; i < 100; ++i) a[i] = counted(i);
+        for (int i = 0; i < 7; ++i) b[-i] = counted(-i);
+        check("map", a, b, same_map<sjtu::map<int, counted> >);
+    }
+    {
+        sjtu::linked_hashmap<int, counted> a, b;
+        for (int i = 0; i < 100; ++i) a[i] = counted(i);
+        for (int i = 0; i < 7; ++i) b[-i] = counted(-i);
+        check("linked_hashmap", a, b, same_map<sjtu::linked_hashmap<int, counted> >);
+    }
+    {
+        sjtu::priority_queue<counted> a, b;
+        for (int i = 0; i < 100; ++i) a.push(counted(i));
+        for (int i = 0; i < 7; ++i) b.push(counted(-i));
+        check("priority_queue", a, b, same_queue<sjtu::priority_queue<counted> >);
+    }
+    return 0;
+}
@@ -0,0 +1,188 @@
+#ifndef SJTU_THREAD_POOL_HPP
+#define SJTU_THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace sjtu {
+/**
+ * a fixed number of worker threads with work stealing.
+ * every worker owns a queue: tasks submitted by a worker go to the back of its own queue
+ *   and it runs the newest of them first, while idle workers steal the oldest ones
+ *   from the front of the other queues.
+ * tasks submitted by other threads go to a shared queue that every worker takes from.
+ * tasks must not throw.
+ * a thread waiting for tasks (see task_group::wait) runs queued tasks itself instead of
+ *   blocking, so tasks may submit and wait for further tasks without deadlock.
+ */
+class thread_pool {
+private:
+    //list.hpp的sort要用到这里，所以队列不能用sjtu::list
+    class task_queue {
+    public:
+        std::mutex mtx;
+        std::deque<std::function<void()>> tasks;
+    };
+    //当前线程是哪个线程池的第几个worker
+    class worker_id {
+    public:
+        const thread_pool *pool;
+        size_t index;
+    };
+    static worker_id &current() {
+        static thread_local worker_id id = {nullptr, 0};
+        return id;
+    }
+    //queues[num]是外部线程提交任务用的公共队列
+    task_queue *queues;
+    std::thread *workers;
+    size_t num;
+    std::atomic<size_t> queued;
+    std::mutex sleep_mtx;
+    std::condition_variable cv;
+    bool stop;
+    size_t self() const {
+        const worker_id &id = current();
+        return id.pool == this ? id.index : num;
+    }
+    bool pop_back(size_t i, std::function<void()> &task) {
+        std::lock_guard<std::mutex> lock(queues[i].mtx);
+        if (queues[i].tasks.empty()) return false;
+        task = std::move(queues[i].tasks.back());
+        queues[i].tasks.pop_back();
+        return true;
+    }
+    bool pop_front(size_t i, std::function<void()> &task) {
+        std::lock_guard<std::mutex> lock(queues[i].mtx);
+        if (queues[i].tasks.empty()) return false;
+        task = std::move(queues[i].tasks.front());
+        queues[i].tasks.pop_front();
+        return true;
+    }
+    //先取自己队列里最新的，再取公共队列，最后从别的worker那里偷最老的
+    bool take(size_t me, std::function<void()> &task) {
+        if (queued.load() == 0) return false;
+        bool got = (me < num && pop_back(me, task)) || pop_front(num, task);
+        for (size_t k = 1; !got && k <= num;++k) {
+            size_t victim = (me + k) % (num + 1);
+            if (victim != num) got = pop_front(victim, task);
+        }
+        if (got) --queued;
+        return got;
+    }
+    void work(size_t me) {
+        current().pool = this;
+        current().index = me;
+        std::function<void()> task;
+        while (true) {
+            if (take(me, task)) {
+                task();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleep_mtx);
+            cv.wait(lock, [this] { return stop || queued.load() > 0; });
+            if (stop && queued.load() == 0) return;
+        }
+    }
+public:
+    /**
+     * start n worker threads, at least one.
+     */
+    explicit thread_pool(size_t n = std::thread::hardware_concurrency()) : num(n ? n : 1), queued(0), stop(false) {
+        queues = new task_queue[num + 1];
+        workers = new std::thread[num];
+        for (size_t i = 0; i < num;++i) workers[i] = std::thread([this, i] { work(i); });
+    }
+    thread_pool(const thread_pool &) = delete;
+    thread_pool &operator=(const thread_pool &) = delete;
+    /**
+     * finish the queued tasks and join the workers.
+     */
+    ~thread_pool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mtx);
+            stop = true;
+        }
+        cv.notify_all();
+        for (size_t i = 0; i < num;++i) workers[i].join();
+        delete [] workers;
+        delete [] queues;
+    }
+    /**
+     * returns the number of worker threads.
+     */
+    size_t size() const {
+        return num;
+    }
+    void submit(std::function<void()> task) {
+        size_t me = self();
+        {
+            std::lock_guard<std::mutex> lock(queues[me].mtx);
+            queues[me].tasks.push_back(std::move(task));
+        }
+        ++queued;
+        //先拿一下锁，保证正要睡下的worker不会错过这次唤醒
+        { std::lock_guard<std::mutex> lock(sleep_mtx); }
+        cv.notify_one();
+    }
+    /**
+     * run one queued task on the calling thread.
+     * return false if there was nothing to run.
+     */
+    bool run_one() {
+        std::function<void()> task;
+        if (!take(self(), task)) return false;
+        task();
+        return true;
+    }
+    /**
+     * the pool shared by the parallel algorithms when none is given,
+     *   with one worker per hardware thread.
+     */
+    static thread_pool &shared() {
+        static thread_pool pool;
+        return pool;
+    }
+};
+
+/**
+ * a set of tasks submitted to a pool which can be waited for together.
+ */
+class task_group {
+private:
+    thread_pool &pool;
+    std::atomic<size_t> pending;
+public:
+    explicit task_group(thread_pool &_pool) : pool(_pool), pending(0) {}
+    task_group(const task_group &) = delete;
+    task_group &operator=(const task_group &) = delete;
+    ~task_group() {
+        wait();
+    }
+    template<class F>
+    void run(F f) {
+        ++pending;
+        pool.submit([this, f]() mutable {
+            f();
+            --pending;
+        });
+    }
+    /**
+     * block until every task run through this group has finished,
+     *   helping with queued tasks meanwhile.
+     */
+    void wait() {
+        while (pending.load()) {
+            if (!pool.run_one()) std::this_thread::yield();
+        }
+    }
+};
+
+}
+
+#endif
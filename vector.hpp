@@ -2,12 +2,209 @@
 #define SJTU_VECTOR_HPP
 
 #include "exceptions.hpp"
+#include "stats.hpp"
 #include <iostream>
 #include <cstdio>
 #include <climits>
 #include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <utility>
+#include <type_traits>
 
 namespace sjtu {
+/**
+ * the iterators of vector and small_vector: an index and the container, dereferenced
+ *   through Vec::data().
+ */
+namespace vector_detail {
+//申请能放n个元素的空间，字节数溢出或malloc失败时抛bad_alloc
+template<class T>
+T *allocate(size_t n){
+    if (n == 0) return nullptr;
+    if (n > size_t(-1) / sizeof(T)) throw std::bad_alloc();
+    T *res = (T *)malloc(n * sizeof(T));
+    if (res == nullptr) throw std::bad_alloc();
+    return res;
+}
+template<class Vec, class T>
+class const_iterator;
+template<class Vec, class T>
+class iterator {
+private:
+    /**
+     * TODO add data members
+     *   just add whatever you want.
+     */
+public:
+    size_t po;
+    Vec *vec;
+    iterator(){}
+    iterator(size_t _pos,Vec* _vec):po(_pos),vec(_vec){}
+    /**
+     * return a new iterator which pointer n-next elements
+     * as well as operator-
+     */
+    iterator operator+(const int &n) const {
+        //TODO
+        iterator tmp = *this;
+        tmp.po += n;
+        return tmp;
+    }
+    iterator operator-(const int &n) const {
+        //TODO
+        iterator tmp = *this;
+        tmp.po -= n;
+        return tmp;
+    }
+    // return the distance between two iterators,
+    // if these two iterators point to different vectors, throw invaild_iterator.
+    int operator-(const iterator &rhs) const {
+        //TODO
+        if (this->vec!=rhs.vec)
+            throw invalid_iterator();
+        //潜在错误：是否取绝对值、正负
+        return this->po - rhs.po;
+    }
+    iterator& operator+=(const int &n) {
+        //TODO
+        this->po += n;
+        return *this;
+    }
+    iterator& operator-=(const int &n) {
+        //TODO
+        this->po -= n;
+        return *this;
+    }
+    /**
+     * TODO iter++
+     */
+    iterator operator++(int) {
+        iterator tmp = *this;
+        ++this->po;
+        return tmp;
+    }
+    /**
+     * TODO ++iter
+     */
+    iterator& operator++() {
+        ++this->po;
+        return *this;
+    }
+    /**
+     * TODO iter--
+     */
+    iterator operator--(int) {
+        iterator tmp = *this;
+        --this->po;
+        return tmp;
+    }
+    /**
+     * TODO --iter
+     */
+    iterator& operator--() {
+        --this->po;
+        return *this;
+    }
+    /**
+     * TODO *it
+     */
+    T& operator*() const{
+        return this->vec->data()[po];
+    }
+    /**
+     * a operator to check whether two iterators are same (pointing to the same memory address).
+     */
+    bool operator==(const iterator &rhs) const {
+        if (this->vec==rhs.vec && this->po==rhs.po) return 1;
+        return 0;
+    }
+    bool operator==(const const_iterator<Vec, T> &rhs) const {
+        if (this->vec==rhs.vec && this->po==rhs.po) return 1;
+        return 0;
+    }
+    /**
+     * some other operator for iterator.
+     */
+    bool operator!=(const iterator &rhs) const {
+        return !(this->operator==(rhs));
+    }
+    bool operator!=(const const_iterator<Vec, T> &rhs) const {
+        return !(this->operator==(rhs));
+    }
+};
+/**
+ * TODO
+ * has same function as iterator, just for a const object.
+ */
+template<class Vec, class T>
+class const_iterator {
+public:
+    size_t po;
+    const Vec *vec;
+    const_iterator(){}
+    const_iterator(size_t _pos,const Vec* _vec):po(_pos),vec(_vec){}
+    const_iterator(const iterator<Vec, T> &other):po(other.po),vec(other.vec){}
+    const_iterator operator+(const int &n) const {
+        const_iterator tmp(this->po + n, this->vec);
+        return tmp;
+    }
+    const_iterator operator-(const int &n) const {
+        const_iterator tmp(this->po-n,this->vec);
+        return tmp;
+    }
+    int operator-(const const_iterator &rhs) const {
+        if (this->vec!=rhs.vec)
+            throw invalid_iterator();
+            //潜在错误：是否取绝对值、正负
+        return this->po - rhs.po;
+    }
+    const_iterator& operator+=(const int &n) {
+        this->po += n;
+        return *this;
+    }
+    const_iterator& operator-=(const int &n) {
+        this->po -= n;
+        return *this;
+    }
+    const_iterator operator++(int) {
+        const_iterator tmp = *this;
+        ++this->po;
+        return tmp;
+    }
+    const_iterator& operator++() {
+        ++this->po;
+        return *this;
+    }
+    const_iterator operator--(int) {
+        const_iterator tmp = *this;
+        --this->po;
+        return tmp;
+    }
+    const_iterator& operator--() {
+        --this->po;
+        return *this;
+    }
+    const T& operator*() const{
+        return this->vec->data()[po];
+    }
+    bool operator==(const iterator<Vec, T> &rhs) const {
+        if (this->vec==rhs.vec && this->po==rhs.po) return 1;
+        return 0;
+    }
+    bool operator==(const const_iterator<Vec, T> &rhs) const {
+        if (this->vec==rhs.vec && this->po==rhs.po) return 1;
+        return 0;
+    }
+    bool operator!=(const iterator<Vec, T> &rhs) const {
+        return !(this->operator==(rhs));
+    }
+    bool operator!=(const const_iterator<Vec, T> &rhs) const {
+        return !(this->operator==(rhs));
+    }
+};
+}
+
 /**
  * a data container like std::vector
  * store data in a successive memory and support random access.
@@ -15,19 +212,80 @@ namespace sjtu {
 template<typename T>
 class vector {
 private:
-    T *data;
+    T *elems;
     size_t cur_len;
     size_t max_len;
-    void doubleSpace(){
-        T *tmp = data;
-        data = (T *)malloc(2 * max_len * sizeof(T));
+#ifdef SJTU_STATS
+    vector_stats counters;
+    void count_alloc(size_t len){
+        ++counters.allocations;
+        counters.bytes_allocated += len * sizeof(T);
+    }
+#endif
+    //把元素搬到一块大小为new_len(>=cur_len)的新空间，申请失败时原样不动
+    void reallocate(size_t new_len){
+        T *tmp = vector_detail::allocate<T>(new_len);
+        SJTU_STAT(if (new_len) count_alloc(new_len);)
+        SJTU_STAT(counters.bytes_copied += cur_len * sizeof(T);)
         for (size_t i = 0; i < cur_len;++i){
-            new (data + i) T(tmp[i]);
-            tmp[i].~T();
+            new (tmp + i) T(std::move(elems[i]));
+            elems[i].~T();
         }
-        max_len *= 2;
-        free(tmp);
+        free(elems);
+        elems = tmp;
+        max_len = new_len;
     }
+    void doubleSpace(){
+        //默认构造和被移走的vector容量为0
+        SJTU_STAT(++counters.grows;)
+        reallocate(max_len ? 2 * max_len : 1);
+    }
+    //在下标ind处空出k个未构造的位置：最多扩容一次，尾部只整体后移一次
+    void open_gap(size_t ind, size_t k){
+        if (k == 0) return;
+        if (cur_len + k > max_len) {
+            size_t new_len = 2 * max_len > cur_len + k ? 2 * max_len : cur_len + k;
+            T *tmp = elems;
+            elems = vector_detail::allocate<T>(new_len);
+            SJTU_STAT(++counters.grows;)
+            SJTU_STAT(count_alloc(new_len);)
+            SJTU_STAT(counters.bytes_copied += cur_len * sizeof(T);)
+            for (size_t i = 0; i < ind;++i){
+                new (elems + i) T(std::move(tmp[i]));
+                tmp[i].~T();
+            }
+            for (size_t i = ind; i < cur_len;++i){
+                new (elems + i + k) T(std::move(tmp[i]));
+                tmp[i].~T();
+            }
+            max_len = new_len;
+            free(tmp);
+            return;
+        }
+        for (size_t i = cur_len; i > ind;--i){
+            new (elems + i - 1 + k) T(std::move(elems[i - 1]));
+            elems[i - 1].~T();
+        }
+    }
+    //析构[ind, ind + k)并把尾部整体前移k个位置
+    void close_gap(size_t ind, size_t k){
+        if (k == 0) return;
+        for (size_t i = ind; i < ind + k;++i) elems[i].~T();
+        for (size_t i = ind + k; i < cur_len;++i){
+            new (elems + i - k) T(std::move(elems[i]));
+            elems[i].~T();
+        }
+        cur_len -= k;
+    }
+    template<class InputIterator>
+    static size_t distance(InputIterator first, InputIterator last){
+        size_t k = 0;
+        for (;first != last;++first) ++k;
+        return k;
+    }
+    //整数参数不能当成迭代器
+    template<class InputIterator>
+    using if_iterator = typename std::enable_if<!std::is_integral<InputIterator>::value>::type;
 public:
     /**
      * TODO
@@ -36,241 +294,158 @@ public:
      */
     /**
      * you can see RandomAccessIterator at CppReference for help.
+     *
+     * define SJTU_VECTOR_UNCHECKED before including this file to drop the bounds check of
+     *   operator[] and use raw pointers as iterators, so that loops over a vector compile
+     *   to the same code as loops over an array (and can be vectorized).
+     * at() always checks the boundary.
      */
-    
-    class const_iterator;
-    class iterator {
-    private:
-        /**
-         * TODO add data members
-         *   just add whatever you want.
-         */
-    public:
-        size_t po;
-        vector *vec;
-        iterator(){}
-        iterator(size_t _pos,vector* _vec):po(_pos),vec(_vec){}
-        /**
-         * return a new iterator which pointer n-next elements
-         * as well as operator-
-         */
-        iterator operator+(const int &n) const {
-            //TODO
-            iterator tmp = *this;
-            tmp.po += n;
-            return tmp;
-        }
-        iterator operator-(const int &n) const {
-            //TODO
-            iterator tmp = *this;
-            tmp.po -= n;
-            return tmp;
-        }
-        // return the distance between two iterators,
-        // if these two iterators point to different vectors, throw invaild_iterator.
-        int operator-(const iterator &rhs) const {
-            //TODO
-            if (this->vec!=rhs.vec)
-                throw invalid_iterator();
-            //潜在错误：是否取绝对值、正负
-            return this->po - rhs.po;
-        }
-        iterator& operator+=(const int &n) {
-            //TODO
-            this->po += n;
-            return *this;
-        }
-        iterator& operator-=(const int &n) {
-            //TODO
-            this->po -= n;
-            return *this;
-        }
-        /**
-         * TODO iter++
-         */
-        iterator operator++(int) {
-            iterator tmp = *this;
-            ++this->po;
-            return tmp;
-        }
-        /**
-         * TODO ++iter
-         */
-        iterator& operator++() {
-            ++this->po;
-            return *this;
-        }
-        /**
-         * TODO iter--
-         */
-        iterator operator--(int) {
-            iterator tmp = *this;
-            --this->po;
-            return tmp;
-        }
-        /**
-         * TODO --iter
-         */
-        iterator& operator--() {
-            --this->po;
-            return *this;
-        }
-        /**
-         * TODO *it
-         */
-        T& operator*() const{
-            return this->vec->data[po];
-        }
-        /**
-         * a operator to check whether two iterators are same (pointing to the same memory address).
-         */
-        bool operator==(const iterator &rhs) const {
-            if (this->vec==rhs.vec && this->po==rhs.po) return 1;
-            return 0;
-        }
-        bool operator==(const const_iterator &rhs) const {
-            if (this->vec==rhs.vec && this->po==rhs.po) return 1;
-            return 0;
-        }
-        /**
-         * some other operator for iterator.
-         */
-        bool operator!=(const iterator &rhs) const {
-            return !(this->operator==(rhs));
-        }
-        bool operator!=(const const_iterator &rhs) const {
-            return !(this->operator==(rhs));
-        }
-    };
-    /**
-     * TODO
-     * has same function as iterator, just for a const object.
-     */
-    class const_iterator {
-    public:
-        size_t po;
-        const vector *vec;
-        const_iterator(){}
-        const_iterator(size_t _pos,const vector* _vec):po(_pos),vec(_vec){}
-        const_iterator operator+(const int &n) const {
-            const_iterator tmp(this->po + n, this->vec);
-            return tmp;
-        }
-        const_iterator operator-(const int &n) const {
-            const_iterator tmp(this->po-n,this->vec);
-            return tmp;
-        }
-        int operator-(const const_iterator &rhs){
-            if (this->vec!=rhs.vec)
-                throw invalid_iterator();
-                //潜在错误：是否取绝对值、正负
-            return this->po - rhs.po;
-        }
-        const_iterator& operator+=(const int &n) {
-            this->po += n;
-            return *this;
-        }
-        const_iterator& operator-=(const int &n) {
-            this->po -= n;
-            return *this;
-        }
-        const_iterator operator++(int) {
-            const_iterator tmp = *this;
-            ++this->po;
-            return tmp;
-        }
-        const_iterator& operator++() {
-            ++this->po;
-            return *this;
-        }
-        const_iterator operator--(int) {
-            const_iterator tmp = *this;
-            --this->po;
-            return tmp;
-        }
-        const_iterator& operator--() {
-            --this->po;
-            return *this;
-        }
-        const T& operator*() const{
-            return this->vec->data[po];
-        }
-        bool operator==(const iterator &rhs) const {
-            if (this->vec==rhs.vec && this->po==rhs.po) return 1;
-            return 0;
-        }
-        bool operator==(const const_iterator &rhs) const {
-            if (this->vec==rhs.vec && this->po==rhs.po) return 1;
-            return 0;
-        }
-        bool operator!=(const iterator &rhs) const {
-            return !(this->operator==(rhs));
-        }
-        bool operator!=(const const_iterator &rhs) const {
-            return !(this->operator==(rhs));
-        }
-    };
+#ifdef SJTU_VECTOR_UNCHECKED
+    typedef T *iterator;
+    typedef const T *const_iterator;
+private:
+    size_t index_of(const_iterator it) const {
+        return it - elems;
+    }
+    iterator make_iterator(size_t po) {
+        return elems + po;
+    }
+    const_iterator make_iterator(size_t po) const {
+        return elems + po;
+    }
+public:
+#else
+    typedef vector_detail::iterator<vector, T> iterator;
+    typedef vector_detail::const_iterator<vector, T> const_iterator;
+private:
+    size_t index_of(const iterator &it) const {
+        return it.po;
+    }
+    size_t index_of(const const_iterator &it) const {
+        return it.po;
+    }
+    iterator make_iterator(size_t po) {
+        return iterator(po, this);
+    }
+    const_iterator make_iterator(size_t po) const {
+        return const_iterator(po, this);
+    }
+public:
+#endif
     /**
      * TODO Constructs
      * Atleast two: default constructor, copy constructor
      */
     vector() {
+        //第一次插入时才分配空间
         cur_len = 0;
-        max_len = 1;
-        data = (T*)malloc(max_len*sizeof(T));
+        max_len = 0;
+        elems = nullptr;
     }
     vector(const vector &other) {
         this->cur_len = other.cur_len;
         //潜在错误：T可能没有默认的构造函数and没free空间
         this->max_len = other.max_len;
-        this->data = (T*)malloc(max_len*sizeof(T));
-        for (size_t i = 0; i < cur_len;++i) new (data + i) T(other.data[i]);
+        this->elems = vector_detail::allocate<T>(max_len);
+        SJTU_STAT(if (max_len) count_alloc(max_len);)
+        for (size_t i = 0; i < cur_len;++i) new (elems + i) T(other.elems[i]);
+    }
+    /**
+     * move constructor, takes over the buffer of other in O(1).
+     * other is left empty with no buffer.
+     */
+    vector(vector &&other) noexcept {
+        this->elems = other.elems;
+        this->cur_len = other.cur_len;
+        this->max_len = other.max_len;
+        other.elems = nullptr;
+        other.cur_len = 0;
+        other.max_len = 0;
     }
     /**
      * TODO Destructor
      */
     ~vector() {
         clear();
-        free(data);
+        free(elems);
     }
     /**
      * TODO Assignment operator
      */
     vector &operator=(const vector &other) {
-        if (this->data==other.data) return *this;
+        if (this->elems==other.elems) return *this;
+        T *tmp = vector_detail::allocate<T>(other.max_len);
+        clear();
+        free(this->elems);
+        this->cur_len = other.cur_len;
+        this->max_len = other.max_len;
+        this->elems = tmp;
+        SJTU_STAT(if (max_len) count_alloc(max_len);)
+        for (size_t i = 0; i < cur_len;++i) new (elems + i) T(other.elems[i]);
+        return *this;
+    }
+    /**
+     * move assignment, releases the old contents and takes over the buffer of other.
+     */
+    vector &operator=(vector &&other) noexcept {
+        if (this==&other) return *this;
         clear();
-        free(this->data);
+        free(this->elems);
+        this->elems = other.elems;
         this->cur_len = other.cur_len;
         this->max_len = other.max_len;
-        this->data = (T *)malloc(max_len * sizeof(T));
-        for (size_t i = 0; i < cur_len;++i) new (data + i) T(other.data[i]);
+        other.elems = nullptr;
+        other.cur_len = 0;
+        other.max_len = 0;
         return *this;
     }
+    /**
+     * exchanges the contents with other in O(1), no element is copied.
+     */
+    void swap(vector &other) noexcept {
+        std::swap(this->elems, other.elems);
+        std::swap(this->cur_len, other.cur_len);
+        std::swap(this->max_len, other.max_len);
+    }
     /**
      * assigns specified element with bounds checking
      * throw index_out_of_bound if pos is not in [0, size)
      */
     T & at(const size_t &pos) {
         if (pos<0||pos>=cur_len) throw index_out_of_bound();
-        return this->data[pos];
+        return this->elems[pos];
     }
     const T & at(const size_t &pos) const {
         if (pos<0||pos>=cur_len) throw index_out_of_bound();
-        return this->data[pos];
+        return this->elems[pos];
     }
     /**
      * assigns specified element with bounds checking
      * throw index_out_of_bound if pos is not in [0, size)
      * !!! Pay attentions
      *   In STL this operator does not check the boundary but I want you to do.
+     *   (unless SJTU_VECTOR_UNCHECKED is defined)
      */
     T & operator[](const size_t &pos) {
-        if (pos<0||pos>=cur_len) throw index_out_of_bound();
-        return this->data[pos];
+#ifndef SJTU_VECTOR_UNCHECKED
+        if (pos>=cur_len) throw index_out_of_bound();
+#endif
+        return this->elems[pos];
     }
     const T & operator[](const size_t &pos) const {
-        if (pos<0||pos>=cur_len) throw index_out_of_bound();
-        return this->data[pos];
+#ifndef SJTU_VECTOR_UNCHECKED
+        if (pos>=cur_len) throw index_out_of_bound();
+#endif
+        return this->elems[pos];
+    }
+    /**
+     * direct access to the underlying contiguous storage, valid until the next reallocation.
+     */
+    T * data() {
+        return this->elems;
+    }
+    const T * data() const {
+        return this->elems;
     }
     /**
      * access the first element.
@@ -278,7 +453,7 @@ public:
      */
     const T & front() const {
         if (cur_len==0) throw container_is_empty();
-        return this->data[0];
+        return this->elems[0];
     }
     /**
      * access the last element.
@@ -286,29 +461,31 @@ public:
      */
     const T & back() const {
         if (cur_len==0) throw container_is_empty();
-        return this->data[cur_len - 1];
+        return this->elems[cur_len - 1];
     }
     /**
      * returns an iterator to the beginning.
      */
     iterator begin() {
-        iterator iter(0, this);
-        return iter;
+        return make_iterator(0);
+    }
+    const_iterator begin() const {
+        return make_iterator(0);
     }
     const_iterator cbegin() const {
-        const_iterator c_iter(0, this);
-        return c_iter;
+        return make_iterator(0);
     }
     /**
-     * returns an iterator to the end.
+     * returns an iterator to the end (one past the last element).
      */
     iterator end() {
-        iterator iter(cur_len - 1, this);
-        return iter;
+        return make_iterator(cur_len);
+    }
+    const_iterator end() const {
+        return make_iterator(cur_len);
     }
     const_iterator cend() const {
-        const_iterator c_iter(cur_len - 1, this);
-        return c_iter;
+        return make_iterator(cur_len);
     }
     /**
      * checks whether the container is empty
@@ -323,13 +500,39 @@ public:
     size_t size() const {
         return cur_len;
     }
+    /**
+     * returns the number of elements that can be held without reallocation
+     */
+    size_t capacity() const {
+        return max_len;
+    }
+    /**
+     * returns the counters of this vector when compiled with SJTU_STATS, zeros otherwise.
+     */
+    vector_stats stats() const {
+        vector_stats res;
+        SJTU_STAT(res = counters;)
+        return res;
+    }
+    /**
+     * increases the capacity to at least new_cap, does nothing if it is already enough.
+     */
+    void reserve(size_t new_cap) {
+        if (new_cap > max_len) reallocate(new_cap);
+    }
+    /**
+     * reduces the capacity to size(), releasing the buffer if the vector is empty.
+     */
+    void shrink_to_fit() {
+        if (max_len > cur_len) reallocate(cur_len);
+    }
     /**
      * clears the contents
      */
     void clear() {
         //也可以顺便改改max_len
         for (size_t i = 0; i < cur_len;++i){
-            data[i].~T();
+            elems[i].~T();
         }
         cur_len = 0;
     }
@@ -338,13 +541,7 @@ public:
      * returns an iterator pointing to the inserted value.
      */
     iterator insert(iterator pos, const T &value) {
-        if (cur_len>=max_len) doubleSpace();
-        for (size_t i = cur_len; i > pos.po;--i){
-            new (data + i) T(data[i - 1]);
-        }
-        new (data + pos.po) T(value);
-        ++cur_len;
-        return pos;
+        return insert(index_of(pos), value);
     }
     /**
      * inserts value at index ind.
@@ -354,14 +551,48 @@ public:
      */
     iterator insert(const size_t &ind, const T &value) {
         if (ind>cur_len) throw index_out_of_bound();
-        if (cur_len>=max_len) doubleSpace();
-        iterator iter(ind, this);
-        for (size_t i = cur_len; i > ind;--i){
-            new (data + i) T(data[i - 1]);
-        }
-        new (data + ind) T(value);
+        if (&value >= elems && &value < elems + cur_len) {
+            //value就是容器里的元素，挪动之前先拷出来
+            T tmp(value);
+            return insert(ind, tmp);
+        }
+        size_t pos = ind;
+        open_gap(pos, 1);
+        new (elems + pos) T(value);
         ++cur_len;
-        return iter;
+        return make_iterator(pos);
+    }
+    /**
+     * inserts count copies of value before pos.
+     * returns an iterator pointing to the first inserted value (pos if count == 0).
+     */
+    iterator insert(iterator pos, size_t count, const T &value) {
+        size_t ind = index_of(pos);
+        if (ind>cur_len) throw index_out_of_bound();
+        if (count==0) return make_iterator(ind);
+        if (&value >= elems && &value < elems + cur_len) {
+            T tmp(value);
+            return insert(pos, count, tmp);
+        }
+        open_gap(ind, count);
+        for (size_t i = 0; i < count;++i) new (elems + ind + i) T(value);
+        cur_len += count;
+        return make_iterator(ind);
+    }
+    /**
+     * inserts the elements of [first, last) before pos, growing and shifting the tail only once.
+     * [first, last) must be traversable twice and must not point into this vector.
+     * returns an iterator pointing to the first inserted element (pos if the range is empty).
+     */
+    template<class InputIterator, class = if_iterator<InputIterator>>
+    iterator insert(iterator pos, InputIterator first, InputIterator last) {
+        size_t ind = index_of(pos);
+        if (ind>cur_len) throw index_out_of_bound();
+        size_t count = distance(first, last);
+        open_gap(ind, count);
+        for (size_t i = 0; i < count;++i, ++first) new (elems + ind + i) T(*first);
+        cur_len += count;
+        return make_iterator(ind);
     }
     /**
      * removes the element at pos.
@@ -369,13 +600,7 @@ public:
      * If the iterator pos refers the last element, the end() iterator is returned.
      */
     iterator erase(iterator pos) {
-        for (size_t i = pos.po; i < cur_len - 1;++i){
-            new (data + i) T(data[i + 1]);
-        }
-        --cur_len;
-        data[cur_len].~T();
-        if (pos.po==cur_len) return end();
-        return pos;
+        return erase(index_of(pos));
     }
     /**
      * removes the element with index ind.
@@ -384,24 +609,98 @@ public:
      */
     iterator erase(const size_t &ind) {
         if (ind>=cur_len) throw index_out_of_bound();
-        iterator iter(ind, this);
-        for (size_t i = ind; i < cur_len - 1;++i){
-            new (data + i) T(data[i + 1]);
+        size_t pos = ind;
+        close_gap(pos, 1);
+        return make_iterator(pos);
+    }
+    /**
+     * removes the elements in [first, last), shifting the tail only once.
+     * return an iterator pointing to the element that followed the last removed one.
+     * throw index_out_of_bound if the range is not inside [begin(), end()]
+     */
+    iterator erase(iterator first, iterator last) {
+        size_t l = index_of(first), r = index_of(last);
+        if (l>r || r>cur_len) throw index_out_of_bound();
+        close_gap(l, r - l);
+        return make_iterator(l);
+    }
+    /**
+     * appends the elements of [first, last) to the end, growing at most once.
+     * [first, last) must be traversable twice and must not point into this vector.
+     */
+    template<class InputIterator, class = if_iterator<InputIterator>>
+    void append(InputIterator first, InputIterator last) {
+        insert(end(), first, last);
+    }
+    void append(const vector &other) {
+        if (this==&other) {
+            vector tmp(other);
+            append(tmp);
+            return;
+        }
+        reserve(cur_len + other.cur_len);
+        for (size_t i = 0; i < other.cur_len;++i) new (elems + cur_len + i) T(other.elems[i]);
+        cur_len += other.cur_len;
+    }
+    /**
+     * replaces the contents with the elements of [first, last).
+     * [first, last) must be traversable twice and must not point into this vector.
+     */
+    template<class InputIterator, class = if_iterator<InputIterator>>
+    void assign(InputIterator first, InputIterator last) {
+        clear();
+        reserve(distance(first, last));
+        for (;first != last;++first) new (elems + cur_len++) T(*first);
+    }
+    /**
+     * replaces the contents with count copies of value.
+     */
+    void assign(size_t count, const T &value) {
+        if (&value >= elems && &value < elems + cur_len) {
+            T tmp(value);
+            assign(count, tmp);
+            return;
         }
-        --cur_len;
-        data[cur_len].~T();
-        if (ind==cur_len) throw index_out_of_bound();
-        return iter;
+        clear();
+        reserve(count);
+        for (;cur_len < count;++cur_len) new (elems + cur_len) T(value);
     }
+    /**
+     * changes the number of elements to count,
+     *   appending copies of value or removing elements from the end.
+     */
+    void resize(size_t count, const T &value = T()) {
+        while (cur_len > count) elems[--cur_len].~T();
+        if (count > max_len) {
+            //value可能就是容器里的元素，扩容前先拷出来
+            T tmp(value);
+            SJTU_STAT(++counters.grows;)
+            reallocate(count > 2 * max_len ? count : 2 * max_len);
+            for (;cur_len < count;++cur_len) new (elems + cur_len) T(tmp);
+            return;
+        }
+        for (;cur_len < count;++cur_len) new (elems + cur_len) T(value);
+    }
+#ifdef SJTU_VECTOR_UNCHECKED
+    //迭代器是指针时字面量0既能转成size_t也能转成迭代器，按下标处理
+    iterator insert(int ind, const T &value) {
+        return insert(size_t(ind), value);
+    }
+    iterator erase(int ind) {
+        return erase(size_t(ind));
+    }
+#endif
     /**
      * adds an element to the end.
      */
     void push_back(const T &value) {
         if(cur_len==max_len){
+            //value可能就是容器里的元素，扩容前先拷出来
+            T tmp(value);
             doubleSpace();
-            new(data+cur_len)T(value);
+            new(elems+cur_len)T(std::move(tmp));
         }
-        else new(data+cur_len)T(value);
+        else new(elems+cur_len)T(value);
         ++cur_len;
         return;
     }
@@ -412,11 +711,15 @@ public:
     void pop_back() {
         if(cur_len==0) throw container_is_empty();
         --cur_len;
-        data[cur_len].~T();
+        elems[cur_len].~T();
         return;
     }
 };
 
+template<typename T>
+void swap(vector<T> &a, vector<T> &b) noexcept {
+    a.swap(b);
+}
 
 }
 